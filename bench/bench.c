@@ -0,0 +1,919 @@
+/*****************************************************************************
+ * Parutil
+ *   Multi-platform library of parallelized utility functions.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Department of Electrical Engineering, Stanford University
+ * Copyright (c) 2016-2017
+ *************************************************************************//**
+ * @file bench.c
+ *   Benchmark suite for memory operations, scheduling assistance, and atomic operations.
+ *   Built on Linux using `make bench`. Run with `--help` for usage information.
+ *****************************************************************************/
+
+#include "parutil.h"
+
+#include <ctype.h>
+#include <getopt.h>
+#include <numa.h>
+#include <spindle.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+
+// -------- CONSTANTS ------------------------------------------------------ //
+
+/// Smallest buffer size used for memory operation benchmarks, in bytes.
+/// Deliberately below the size at which Parutil parallelizes, so that the serial path is covered too.
+static const size_t kParutilBenchMemoryMinimumSize = 1ull * 1024ull;
+
+/// Default largest buffer size used for memory operation benchmarks, in bytes.
+static const size_t kParutilBenchMemoryDefaultMaximumSize = 256ull * 1024ull * 1024ull;
+
+/// Extra space allocated for each buffer, in bytes, to leave room for the alignment offsets.
+static const size_t kParutilBenchMemoryOffsetSpace = 64;
+
+/// Number of bytes each memory operation benchmark configuration tries to process in total, which determines the number of repetitions.
+static const uint64_t kParutilBenchMemoryTargetBytes = 1ull * 1024ull * 1024ull * 1024ull;
+
+/// Minimum number of timed repetitions for each memory operation benchmark configuration.
+static const uint64_t kParutilBenchMemoryMinimumRepetitions = 3;
+
+/// Maximum number of timed repetitions for each memory operation benchmark configuration.
+static const uint64_t kParutilBenchMemoryMaximumRepetitions = 1000;
+
+/// Number of units of work scheduled in each round of the scheduler benchmarks.
+static const uint64_t kParutilBenchSchedulerUnitsPerRound = 1ull << 20;
+
+/// Number of times each thread calls the static scheduler in each round of the static scheduler benchmarks.
+static const uint64_t kParutilBenchSchedulerStaticCallsPerRound = 1ull << 16;
+
+/// Number of timed rounds for each scheduler benchmark configuration.
+static const uint64_t kParutilBenchSchedulerRounds = 8;
+
+/// Number of atomic operations each thread performs in each round of the atomic benchmarks.
+static const uint64_t kParutilBenchAtomicOpsPerThread = 1ull << 20;
+
+/// Number of timed rounds for each atomic benchmark configuration.
+static const uint64_t kParutilBenchAtomicRounds = 8;
+
+/// Size of a cache line, in bytes.
+static const size_t kParutilBenchCacheLineSize = 64;
+
+
+// -------- TYPE DEFINITIONS ----------------------------------------------- //
+
+/// Enumerates the supported output formats.
+typedef enum EParutilBenchFormat
+{
+    ParutilBenchFormatCSV,                                                  ///< Comma-separated values, one header line followed by one line per result, each of which includes the host and timestamp.
+    ParutilBenchFormatJSON                                                  ///< Single JSON object holding an array of results.
+} EParutilBenchFormat;
+
+/// Enumerates the operations exercised by the memory operation benchmarks.
+typedef enum EParutilBenchMemoryOperation
+{
+    ParutilBenchMemoryOperationCopy,                                        ///< #parutilMemoryCopy versus `memcpy`.
+    ParutilBenchMemoryOperationSet,                                         ///< #parutilMemorySet versus `memset`.
+    ParutilBenchMemoryOperationFilter                                       ///< #parutilMemoryFilter versus a plain loop, since the C library has no equivalent.
+} EParutilBenchMemoryOperation;
+
+/// Enumerates the kinds of work performed within a Spindle task by the scheduler and atomic benchmarks.
+typedef enum EParutilBenchTaskKind
+{
+    ParutilBenchTaskKindSchedulerStatic,                                    ///< Static chunked scheduler, called repeatedly to obtain the same assignment.
+    ParutilBenchTaskKindSchedulerDynamic,                                   ///< Dynamic scheduler, obtaining one unit at a time.
+    ParutilBenchTaskKindAtomicAddShared,                                    ///< #parutilAtomicAdd64 on a single counter shared by all threads.
+    ParutilBenchTaskKindAtomicExchangeAddShared,                            ///< #parutilAtomicExchangeAdd64 on a single counter shared by all threads.
+    ParutilBenchTaskKindAtomicAddPrivate                                    ///< #parutilAtomicAdd64 on a separate cache line per thread, as an uncontended baseline.
+} EParutilBenchTaskKind;
+
+/// Holds a single benchmark result, which becomes one record in the output.
+typedef struct SParutilBenchResult
+{
+    const char* suite;                                                      ///< Benchmark suite: "memory", "scheduler", or "atomic".
+    const char* operation;                                                  ///< Operation measured within the suite.
+    const char* implementation;                                             ///< Implementation measured, either Parutil or a baseline.
+    uint64_t size;                                                          ///< Bytes per call for memory operations, units of work per round for schedulers, or operations per thread per round for atomics.
+    uint32_t destinationOffset;                                             ///< Offset of the destination buffer from a 64-byte boundary, in bytes.
+    uint32_t sourceOffset;                                                  ///< Offset of the source buffer from a 64-byte boundary, in bytes.
+    uint32_t numThreads;                                                    ///< Number of threads requested, or 0 if the implementation chooses for itself.
+    int32_t numaNode;                                                       ///< NUMA node on which the memory or threads were placed.
+    uint64_t repetitions;                                                   ///< Number of timed repetitions.
+    double nsBest;                                                          ///< Fastest repetition, in nanoseconds.
+    double nsMean;                                                          ///< Mean of all repetitions, in nanoseconds.
+    double value;                                                           ///< Headline metric derived from the fastest repetition.
+    const char* unit;                                                       ///< Unit of the headline metric.
+    bool valid;                                                             ///< Whether or not the output of the implementation was checked and found to be correct.
+} SParutilBenchResult;
+
+/// Holds the state of the output stream.
+typedef struct SParutilBenchOutput
+{
+    FILE* stream;                                                           ///< Stream to which results are written.
+    EParutilBenchFormat format;                                             ///< Format in which results are written.
+    uint64_t numResults;                                                    ///< Number of results written so far.
+    char host[256];                                                         ///< Name of the host running the benchmarks, limited to characters that need no escaping in either format.
+    char timestamp[32];                                                     ///< Time at which the benchmarks started, in ISO 8601 format.
+} SParutilBenchOutput;
+
+/// Holds the per-thread state of the scheduler and atomic benchmarks.
+/// Occupies exactly one cache line, so that uncontended atomic counters do not share a cache line.
+typedef struct SParutilBenchThreadSlot
+{
+    uint64_t counter;                                                       ///< Atomic counter. The counter of the first thread is also the shared counter.
+    double nsStart;                                                         ///< Time at which the thread started the current round.
+    double nsEnd;                                                           ///< Time at which the thread finished the current round.
+    uint8_t padding[40];                                                    ///< Unused.
+} SParutilBenchThreadSlot;
+
+/// Specifies the work performed within a Spindle task by the scheduler and atomic benchmarks, and holds the timing results.
+typedef struct SParutilBenchTaskSpec
+{
+    EParutilBenchTaskKind kind;                                             ///< Kind of work to perform.
+    uint64_t size;                                                          ///< Units of work per round or atomic operations per thread per round.
+    uint64_t rounds;                                                        ///< Number of timed rounds.
+    SParutilBenchThreadSlot* threadSlots;                                   ///< Per-thread state, one slot per thread.
+    uint32_t numThreads;                                                    ///< Number of threads that actually ran the task, written by the first thread.
+    double nsBest;                                                          ///< Fastest round, in nanoseconds, written by the first thread.
+    double nsTotal;                                                         ///< Sum of all rounds, in nanoseconds, written by the first thread.
+    bool valid;                                                             ///< Whether or not every unit of work was handed out exactly once or every atomic operation was counted, written by the first thread.
+} SParutilBenchTaskSpec;
+
+
+// -------- GLOBALS -------------------------------------------------------- //
+
+/// Prevents the compiler from optimizing away the loop bodies of the scheduler benchmarks.
+static volatile uint64_t parutilBenchSink;
+
+/// Byte value used by set and filter operations in the memory operation benchmarks.
+/// Loaded anew for every call so that the compiler can neither remove nor hoist the baseline loops, and chosen so that filtering actually changes the data.
+static volatile uint8_t parutilBenchMemoryValue = 0x5a;
+
+
+// -------- INTERNAL FUNCTIONS --------------------------------------------- //
+
+/// Retrieves the current time from a monotonic clock.
+/// @return Current time, in nanoseconds.
+static inline double parutilBenchNow(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((double)now.tv_sec * 1.0e9) + (double)now.tv_nsec;
+}
+
+/// Writes the beginning of the output, if the format requires any.
+/// Also identifies the host and the current time, which are written as part of the output.
+/// @param [in,out] output Output stream state.
+static void parutilBenchOutputBegin(SParutilBenchOutput* output)
+{
+    const time_t now = time(NULL);
+
+    if (0 != gethostname(output->host, sizeof(output->host)))
+        strcpy(output->host, "unknown");
+
+    output->host[sizeof(output->host) - 1] = '\0';
+
+    // Valid host names contain only letters, digits, hyphens, and dots, none of which need escaping in CSV or JSON.
+    // Anything else is replaced, rather than escaped, so that the host name remains usable as a plain identifier.
+    for (char* c = output->host; '\0' != *c; ++c)
+    {
+        if (!isalnum((unsigned char)*c) && ('-' != *c) && ('.' != *c))
+            *c = '_';
+    }
+
+    strftime(output->timestamp, sizeof(output->timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    switch (output->format)
+    {
+    case ParutilBenchFormatCSV:
+        fprintf(output->stream, "host,timestamp,suite,operation,implementation,size,destination_offset,source_offset,num_threads,numa_node,repetitions,ns_best,ns_mean,value,unit,valid\n");
+        break;
+
+    case ParutilBenchFormatJSON:
+        fprintf(output->stream, "{\n  \"benchmark\": \"parutil-bench\",\n  \"host\": \"%s\",\n  \"timestamp\": \"%s\",\n  \"results\": [", output->host, output->timestamp);
+        break;
+    }
+
+    output->numResults = 0;
+}
+
+/// Writes a single result to the output.
+/// @param [in,out] output Output stream state.
+/// @param [in] result Result to write.
+static void parutilBenchOutputResult(SParutilBenchOutput* output, const SParutilBenchResult* result)
+{
+    switch (output->format)
+    {
+    case ParutilBenchFormatCSV:
+        fprintf(output->stream, "%s,%s,%s,%s,%s,%llu,%u,%u,%u,%d,%llu,%.1f,%.1f,%.6g,%s,%s\n", output->host, output->timestamp, result->suite, result->operation, result->implementation, (unsigned long long)result->size, result->destinationOffset, result->sourceOffset, result->numThreads, result->numaNode, (unsigned long long)result->repetitions, result->nsBest, result->nsMean, result->value, result->unit, (result->valid ? "true" : "false"));
+        break;
+
+    case ParutilBenchFormatJSON:
+        fprintf(output->stream, "%s\n    {\"suite\": \"%s\", \"operation\": \"%s\", \"implementation\": \"%s\", \"size\": %llu, \"destination_offset\": %u, \"source_offset\": %u, \"num_threads\": %u, \"numa_node\": %d, \"repetitions\": %llu, \"ns_best\": %.1f, \"ns_mean\": %.1f, \"value\": %.6g, \"unit\": \"%s\", \"valid\": %s}", ((0 == output->numResults) ? "" : ","), result->suite, result->operation, result->implementation, (unsigned long long)result->size, result->destinationOffset, result->sourceOffset, result->numThreads, result->numaNode, (unsigned long long)result->repetitions, result->nsBest, result->nsMean, result->value, result->unit, (result->valid ? "true" : "false"));
+        break;
+    }
+
+    fflush(output->stream);
+    output->numResults += 1;
+}
+
+/// Writes the end of the output, if the format requires any.
+/// @param [in,out] output Output stream state.
+static void parutilBenchOutputEnd(SParutilBenchOutput* output)
+{
+    switch (output->format)
+    {
+    case ParutilBenchFormatCSV:
+        break;
+
+    case ParutilBenchFormatJSON:
+        fprintf(output->stream, "\n  ]\n}\n");
+        break;
+    }
+
+    fflush(output->stream);
+}
+
+/// Allocates a buffer on the specified NUMA node, falling back to an ordinary aligned allocation if NUMA support is unavailable.
+/// Every page of the buffer is touched before returning, so that page faults are not included in any measurements.
+/// @param [in] size Number of bytes to allocate.
+/// @param [in] numaNode NUMA node on which to allocate.
+/// @return Pointer to the buffer, aligned to at least 64 bytes, or `NULL` on failure.
+static void* parutilBenchAlloc(const size_t size, const int32_t numaNode)
+{
+    void* buffer;
+
+    if (numa_available() >= 0)
+        buffer = numa_alloc_onnode(size, numaNode);
+    else
+        buffer = aligned_alloc(kParutilBenchCacheLineSize, (size + kParutilBenchCacheLineSize - 1) & ~(kParutilBenchCacheLineSize - 1));
+
+    if (NULL != buffer)
+        memset(buffer, 0, size);
+
+    return buffer;
+}
+
+/// Frees a buffer allocated using #parutilBenchAlloc.
+/// @param [in] buffer Buffer to free.
+/// @param [in] size Number of bytes that were allocated.
+static void parutilBenchFree(void* buffer, const size_t size)
+{
+    if (NULL == buffer)
+        return;
+
+    if (numa_available() >= 0)
+        numa_free(buffer, size);
+    else
+        free(buffer);
+}
+
+/// Determines the number of processors available on the specified NUMA node.
+/// @param [in] numaNode NUMA node to query.
+/// @return Number of processors, or 0 if the node has none.
+static uint32_t parutilBenchGetNUMANodeProcessorCount(const int32_t numaNode)
+{
+    uint32_t numProcessors = 0;
+
+    if (numa_available() < 0)
+        return (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+
+    struct bitmask* cpus = numa_allocate_cpumask();
+
+    if ((NULL != cpus) && (0 == numa_node_to_cpus(numaNode, cpus)))
+        numProcessors = numa_bitmask_weight(cpus);
+
+    if (NULL != cpus)
+        numa_free_cpumask(cpus);
+
+    return numProcessors;
+}
+
+/// Runs a single memory operation on the specified buffers.
+/// @param [in] operation Operation to run.
+/// @param [in] useParutil `true` to use Parutil, `false` to use the baseline implementation.
+/// @param [out] destination Destination buffer.
+/// @param [in] source Source buffer, used only for copy operations.
+/// @param [in] value Byte value, used only for set and filter operations.
+/// @param [in] num Number of bytes.
+static void parutilBenchMemoryRun(const EParutilBenchMemoryOperation operation, const bool useParutil, uint8_t* destination, const uint8_t* source, const uint8_t value, const size_t num)
+{
+    switch (operation)
+    {
+    case ParutilBenchMemoryOperationCopy:
+        if (useParutil)
+            parutilMemoryCopy(destination, source, num);
+        else
+            memcpy(destination, source, num);
+        break;
+
+    case ParutilBenchMemoryOperationSet:
+        if (useParutil)
+            parutilMemorySet(destination, value, num);
+        else
+            memset(destination, value, num);
+        break;
+
+    case ParutilBenchMemoryOperationFilter:
+        if (useParutil)
+            parutilMemoryFilter(destination, value, num);
+        else
+        {
+            for (size_t i = 0; i < num; ++i)
+                destination[i] &= value;
+        }
+        break;
+    }
+}
+
+/// Runs a single memory operation once on freshly-initialized buffers and checks the result, including that no bytes outside the destination range were modified.
+/// @param [in] operation Operation to check.
+/// @param [in] useParutil `true` to use Parutil, `false` to use the baseline implementation.
+/// @param [in,out] destinationBase Start of the destination allocation.
+/// @param [in,out] sourceBase Start of the source allocation.
+/// @param [in] allocSize Size of each allocation, in bytes.
+/// @param [in] destinationOffset Offset of the destination from the start of its allocation.
+/// @param [in] sourceOffset Offset of the source from the start of its allocation.
+/// @param [in] num Number of bytes.
+/// @return `true` if the result is correct, `false` otherwise.
+static bool parutilBenchMemoryCheck(const EParutilBenchMemoryOperation operation, const bool useParutil, uint8_t* destinationBase, uint8_t* sourceBase, const size_t allocSize, const uint32_t destinationOffset, const uint32_t sourceOffset, const size_t num)
+{
+    const uint8_t value = parutilBenchMemoryValue;
+    const size_t checkEnd = ((destinationOffset + num + kParutilBenchMemoryOffsetSpace) < allocSize ? (destinationOffset + num + kParutilBenchMemoryOffsetSpace) : allocSize);
+
+    // Only the parts of the buffers that are read or checked need to be initialized.
+    for (size_t i = 0; i < (sourceOffset + num); ++i)
+        sourceBase[i] = (uint8_t)((i * 131) + 7);
+
+    for (size_t i = 0; i < checkEnd; ++i)
+        destinationBase[i] = (uint8_t)((i * 37) + 11);
+
+    parutilBenchMemoryRun(operation, useParutil, &destinationBase[destinationOffset], &sourceBase[sourceOffset], value, num);
+
+    for (size_t i = 0; i < checkEnd; ++i)
+    {
+        const uint8_t original = (uint8_t)((i * 37) + 11);
+        uint8_t expected = original;
+
+        if ((i >= destinationOffset) && (i < (destinationOffset + num)))
+        {
+            switch (operation)
+            {
+            case ParutilBenchMemoryOperationCopy:
+                expected = (uint8_t)(((i - destinationOffset + sourceOffset) * 131) + 7);
+                break;
+
+            case ParutilBenchMemoryOperationSet:
+                expected = value;
+                break;
+
+            case ParutilBenchMemoryOperationFilter:
+                expected = original & value;
+                break;
+            }
+        }
+
+        if (destinationBase[i] != expected)
+            return false;
+    }
+
+    return true;
+}
+
+/// Runs the memory operation benchmarks, comparing Parutil with the C library across buffer sizes and alignments.
+/// @param [in,out] output Output stream state.
+/// @param [in] maximumSize Largest buffer size to use, in bytes.
+/// @return `true` if all checks passed, `false` otherwise.
+static bool parutilBenchMemory(SParutilBenchOutput* output, const size_t maximumSize)
+{
+    static const struct
+    {
+        EParutilBenchMemoryOperation operation;
+        const char* name;
+        const char* baselineName;
+    } kOperations[] = {
+        {ParutilBenchMemoryOperationCopy, "copy", "glibc-memcpy"},
+        {ParutilBenchMemoryOperationSet, "set", "glibc-memset"},
+        {ParutilBenchMemoryOperationFilter, "filter", "c-loop"},
+    };
+
+    // Pairs of destination and source offsets from a 64-byte boundary.
+    // For copy operations these cover both buffers aligned, both equally misaligned, and misaligned relative to each other.
+    // Operations without a source use only the pairs whose offsets are equal.
+    static const uint32_t kOffsets[][2] = {
+        {0, 0},
+        {1, 1},
+        {8, 8},
+        {32, 32},
+        {0, 1},
+        {8, 0},
+    };
+
+    const int32_t numaNode = 0;
+    const size_t allocSize = maximumSize + kParutilBenchMemoryOffsetSpace * 2;
+    uint8_t* destinationBase = (uint8_t*)parutilBenchAlloc(allocSize, numaNode);
+    uint8_t* sourceBase = (uint8_t*)parutilBenchAlloc(allocSize, numaNode);
+    bool allValid = true;
+
+    if ((NULL == destinationBase) || (NULL == sourceBase))
+    {
+        fprintf(stderr, "parutil-bench: unable to allocate %llu bytes for memory benchmarks.\n", (unsigned long long)allocSize);
+        parutilBenchFree(destinationBase, allocSize);
+        parutilBenchFree(sourceBase, allocSize);
+        return false;
+    }
+
+    for (size_t op = 0; op < (sizeof(kOperations) / sizeof(kOperations[0])); ++op)
+    {
+        for (size_t alignment = 0; alignment < (sizeof(kOffsets) / sizeof(kOffsets[0])); ++alignment)
+        {
+            const uint32_t destinationOffset = kOffsets[alignment][0];
+            const uint32_t sourceOffset = kOffsets[alignment][1];
+
+            if ((ParutilBenchMemoryOperationCopy != kOperations[op].operation) && (destinationOffset != sourceOffset))
+                continue;
+
+            fprintf(stderr, "parutil-bench: memory %s, offsets %u/%u\n", kOperations[op].name, destinationOffset, sourceOffset);
+
+            for (size_t size = kParutilBenchMemoryMinimumSize; size <= maximumSize; size <<= 2)
+            {
+                uint64_t repetitions = kParutilBenchMemoryTargetBytes / size;
+
+                if (repetitions < kParutilBenchMemoryMinimumRepetitions)
+                    repetitions = kParutilBenchMemoryMinimumRepetitions;
+                else if (repetitions > kParutilBenchMemoryMaximumRepetitions)
+                    repetitions = kParutilBenchMemoryMaximumRepetitions;
+
+                for (uint32_t impl = 0; impl < 2; ++impl)
+                {
+                    const bool useParutil = (0 == impl);
+                    SParutilBenchResult result;
+
+                    result.suite = "memory";
+                    result.operation = kOperations[op].name;
+                    result.implementation = (useParutil ? "parutil" : kOperations[op].baselineName);
+                    result.size = size;
+                    result.destinationOffset = destinationOffset;
+                    result.sourceOffset = sourceOffset;
+                    result.numThreads = (useParutil ? 0 : 1);
+                    result.numaNode = numaNode;
+                    result.repetitions = repetitions;
+                    result.nsBest = 0.0;
+                    result.nsMean = 0.0;
+                    result.unit = "GB/s";
+
+                    // Checking also serves as a warm-up run.
+                    result.valid = parutilBenchMemoryCheck(kOperations[op].operation, useParutil, destinationBase, sourceBase, allocSize, destinationOffset, sourceOffset, size);
+                    allValid = allValid && result.valid;
+
+                    for (uint64_t rep = 0; rep < repetitions; ++rep)
+                    {
+                        const uint8_t value = parutilBenchMemoryValue;
+                        const double start = parutilBenchNow();
+                        parutilBenchMemoryRun(kOperations[op].operation, useParutil, &destinationBase[destinationOffset], &sourceBase[sourceOffset], value, size);
+                        const double elapsed = parutilBenchNow() - start;
+
+                        if ((0 == rep) || (elapsed < result.nsBest))
+                            result.nsBest = elapsed;
+
+                        result.nsMean += elapsed;
+                    }
+
+                    result.nsMean /= (double)repetitions;
+                    result.value = (double)size / result.nsBest;
+
+                    parutilBenchOutputResult(output, &result);
+                }
+            }
+        }
+    }
+
+    parutilBenchFree(destinationBase, allocSize);
+    parutilBenchFree(sourceBase, allocSize);
+    return allValid;
+}
+
+/// Runs one round of the work specified for a scheduler or atomic benchmark task.
+/// Intended to be called by all threads in the task.
+/// @param [in] taskSpec Specification of the work to perform.
+/// @param [in,out] dynamicSchedule Dynamic scheduler object, used only by dynamic scheduler benchmarks.
+/// @param [in] firstUnit First unit of work obtained from #parutilSchedulerDynamicInit, used only by dynamic scheduler benchmarks.
+/// @return Number of units of work this thread processed or number of atomic operations this thread performed.
+static uint64_t parutilBenchTaskRound(const SParutilBenchTaskSpec* taskSpec, void* dynamicSchedule, const uint64_t firstUnit)
+{
+    const uint32_t threadID = spindleGetLocalThreadID();
+    uint64_t sink = 0;
+    uint64_t numProcessed = 0;
+
+    switch (taskSpec->kind)
+    {
+    case ParutilBenchTaskKindSchedulerStatic:
+        // Only the calls themselves are measured, since iterating over the assigned units would otherwise dominate.
+        // Every call produces the same assignment, so the units assigned are counted once, from the last call.
+        {
+            SParutilStaticSchedule schedule;
+            bool scheduled = false;
+
+            for (uint64_t call = 0; call < kParutilBenchSchedulerStaticCallsPerRound; ++call)
+            {
+                scheduled = parutilSchedulerStatic(ParutilStaticSchedulerChunked, taskSpec->size, &schedule);
+                sink += schedule.startUnit;
+            }
+
+            if (scheduled && (schedule.startUnit < schedule.endUnit))
+                numProcessed = ((schedule.endUnit - schedule.startUnit) + (schedule.increment - 1)) / schedule.increment;
+        }
+        break;
+
+    case ParutilBenchTaskKindSchedulerDynamic:
+        for (uint64_t unit = firstUnit; UINT64_MAX != unit; unit = parutilSchedulerDynamicGetWork(dynamicSchedule))
+        {
+            sink += unit;
+            numProcessed += 1;
+        }
+        break;
+
+    case ParutilBenchTaskKindAtomicAddShared:
+        for (uint64_t i = 0; i < taskSpec->size; ++i)
+            parutilAtomicAdd64(&taskSpec->threadSlots[0].counter, 1ull);
+        numProcessed = taskSpec->size;
+        break;
+
+    case ParutilBenchTaskKindAtomicExchangeAddShared:
+        for (uint64_t i = 0; i < taskSpec->size; ++i)
+            sink += parutilAtomicExchangeAdd64(&taskSpec->threadSlots[0].counter, 1ull);
+        numProcessed = taskSpec->size;
+        break;
+
+    case ParutilBenchTaskKindAtomicAddPrivate:
+        for (uint64_t i = 0; i < taskSpec->size; ++i)
+            parutilAtomicAdd64(&taskSpec->threadSlots[threadID].counter, 1ull);
+        numProcessed = taskSpec->size;
+        break;
+    }
+
+    parutilBenchSink = sink;
+    return numProcessed;
+}
+
+/// Task function for the scheduler and atomic benchmarks.
+/// Each round is delimited by barriers and timed by the first thread.
+/// @param [in,out] arg Pointer to the #SParutilBenchTaskSpec structure that describes the work and receives the results.
+static void parutilBenchTaskThread(void* arg)
+{
+    SParutilBenchTaskSpec* taskSpec = (SParutilBenchTaskSpec*)arg;
+    const uint32_t threadID = spindleGetLocalThreadID();
+    const uint32_t threadCount = spindleGetLocalThreadCount();
+    bool valid = true;
+
+    for (uint64_t round = 0; round < taskSpec->rounds; ++round)
+    {
+        void* dynamicSchedule = NULL;
+        uint64_t firstUnit = UINT64_MAX;
+        uint64_t numProcessed = 0;
+
+        taskSpec->threadSlots[threadID].counter = 0;
+
+        // Creating the dynamic scheduler object involves a memory allocation, which is not part of what is being measured.
+        if (ParutilBenchTaskKindSchedulerDynamic == taskSpec->kind)
+        {
+            firstUnit = parutilSchedulerDynamicInit(taskSpec->size, &dynamicSchedule);
+
+            if (NULL == dynamicSchedule)
+                valid = false;
+        }
+
+        spindleBarrierLocal();
+
+        // Each thread records its own start and end times, and the round lasts from the earliest start to the latest end.
+        // Timing only the first thread would miss any work done before it leaves the barrier.
+        taskSpec->threadSlots[threadID].nsStart = parutilBenchNow();
+
+        if (valid)
+            numProcessed = parutilBenchTaskRound(taskSpec, dynamicSchedule, firstUnit);
+
+        taskSpec->threadSlots[threadID].nsEnd = parutilBenchNow();
+        spindleBarrierLocal();
+
+        if (0 == threadID)
+        {
+            double start = taskSpec->threadSlots[0].nsStart;
+            double end = taskSpec->threadSlots[0].nsEnd;
+
+            for (uint32_t t = 1; t < threadCount; ++t)
+            {
+                if (taskSpec->threadSlots[t].nsStart < start)
+                    start = taskSpec->threadSlots[t].nsStart;
+
+                if (taskSpec->threadSlots[t].nsEnd > end)
+                    end = taskSpec->threadSlots[t].nsEnd;
+            }
+
+            const double elapsed = end - start;
+
+            if ((0 == round) || (elapsed < taskSpec->nsBest))
+                taskSpec->nsBest = elapsed;
+
+            taskSpec->nsTotal += elapsed;
+        }
+
+        // Check that the work was done exactly once, which is of interest for the schedulers, and that all atomic updates landed.
+        switch (taskSpec->kind)
+        {
+        case ParutilBenchTaskKindSchedulerStatic:
+        case ParutilBenchTaskKindSchedulerDynamic:
+            parutilAtomicAdd64(&taskSpec->threadSlots[threadID].counter, numProcessed);
+            spindleBarrierLocal();
+
+            if (0 == threadID)
+            {
+                uint64_t totalProcessed = 0;
+
+                for (uint32_t t = 0; t < threadCount; ++t)
+                    totalProcessed += taskSpec->threadSlots[t].counter;
+
+                valid = valid && (totalProcessed == taskSpec->size);
+            }
+            break;
+
+        case ParutilBenchTaskKindAtomicAddShared:
+        case ParutilBenchTaskKindAtomicExchangeAddShared:
+            if (0 == threadID)
+                valid = valid && (taskSpec->threadSlots[0].counter == (taskSpec->size * threadCount));
+            break;
+
+        case ParutilBenchTaskKindAtomicAddPrivate:
+            if (0 == threadID)
+            {
+                for (uint32_t t = 0; t < threadCount; ++t)
+                    valid = valid && (taskSpec->threadSlots[t].counter == taskSpec->size);
+            }
+            break;
+        }
+
+        if (NULL != dynamicSchedule)
+            parutilSchedulerDynamicExit(dynamicSchedule);
+
+        spindleBarrierLocal();
+    }
+
+    if (0 == threadID)
+    {
+        taskSpec->numThreads = threadCount;
+        taskSpec->valid = valid;
+    }
+}
+
+/// Runs the scheduler and atomic benchmarks across NUMA nodes and thread counts.
+/// @param [in,out] output Output stream state.
+/// @param [in] maximumThreads Largest number of threads to use per NUMA node, or 0 to use all processors on each node.
+/// @return `true` if all checks passed, `false` otherwise.
+static bool parutilBenchTasks(SParutilBenchOutput* output, const uint32_t maximumThreads)
+{
+    static const struct
+    {
+        EParutilBenchTaskKind kind;
+        const char* suite;
+        const char* operation;
+        const char* unit;
+    } kTasks[] = {
+        {ParutilBenchTaskKindSchedulerStatic, "scheduler", "static-chunked", "ns/call"},
+        {ParutilBenchTaskKindSchedulerDynamic, "scheduler", "dynamic", "ns/call"},
+        {ParutilBenchTaskKindAtomicAddShared, "atomic", "add64-shared", "Mops/s"},
+        {ParutilBenchTaskKindAtomicExchangeAddShared, "atomic", "exchange-add64-shared", "Mops/s"},
+        {ParutilBenchTaskKindAtomicAddPrivate, "atomic", "add64-private", "Mops/s"},
+    };
+
+    const int32_t maximumNUMANode = ((numa_available() >= 0) ? numa_max_node() : 0);
+    bool allValid = true;
+
+    for (int32_t numaNode = 0; numaNode <= maximumNUMANode; ++numaNode)
+    {
+        uint32_t numProcessors = parutilBenchGetNUMANodeProcessorCount(numaNode);
+
+        if (0 == numProcessors)
+            continue;
+
+        if ((0 != maximumThreads) && (numProcessors > maximumThreads))
+            numProcessors = maximumThreads;
+
+        const size_t threadSlotsSize = (size_t)numProcessors * sizeof(SParutilBenchThreadSlot);
+        SParutilBenchThreadSlot* threadSlots = (SParutilBenchThreadSlot*)parutilBenchAlloc(threadSlotsSize, numaNode);
+
+        if (NULL == threadSlots)
+        {
+            fprintf(stderr, "parutil-bench: unable to allocate per-thread state on NUMA node %d.\n", numaNode);
+            allValid = false;
+            continue;
+        }
+
+        // Thread counts are powers of two, plus all available processors if that is not already a power of two.
+        for (uint32_t numThreads = 1; 0 != numThreads; numThreads = ((numThreads == numProcessors) ? 0 : (((numThreads << 1) < numProcessors) ? (numThreads << 1) : numProcessors)))
+        {
+            fprintf(stderr, "parutil-bench: scheduler and atomic, NUMA node %d, %u thread(s)\n", numaNode, numThreads);
+
+            for (size_t task = 0; task < (sizeof(kTasks) / sizeof(kTasks[0])); ++task)
+            {
+                const bool isScheduler = ((ParutilBenchTaskKindSchedulerStatic == kTasks[task].kind) || (ParutilBenchTaskKindSchedulerDynamic == kTasks[task].kind));
+                SParutilBenchTaskSpec benchTaskSpec;
+                SSpindleTaskSpec taskSpec;
+                SParutilBenchResult result;
+
+                benchTaskSpec.kind = kTasks[task].kind;
+                benchTaskSpec.size = (isScheduler ? kParutilBenchSchedulerUnitsPerRound : kParutilBenchAtomicOpsPerThread);
+                benchTaskSpec.rounds = (isScheduler ? kParutilBenchSchedulerRounds : kParutilBenchAtomicRounds);
+                benchTaskSpec.threadSlots = threadSlots;
+                benchTaskSpec.numThreads = 0;
+                benchTaskSpec.nsBest = 0.0;
+                benchTaskSpec.nsTotal = 0.0;
+                benchTaskSpec.valid = false;
+
+                taskSpec.func = &parutilBenchTaskThread;
+                taskSpec.arg = (void*)&benchTaskSpec;
+                taskSpec.numaNode = (uint32_t)numaNode;
+                taskSpec.numThreads = numThreads;
+                taskSpec.smtPolicy = SpindleSMTPolicyPreferPhysical;
+
+                if (0 != spindleThreadsSpawn(&taskSpec, 1, false))
+                {
+                    fprintf(stderr, "parutil-bench: unable to spawn %u thread(s) on NUMA node %d.\n", numThreads, numaNode);
+                    allValid = false;
+                    continue;
+                }
+
+                if (benchTaskSpec.numThreads != numThreads)
+                    benchTaskSpec.valid = false;
+
+                result.suite = kTasks[task].suite;
+                result.operation = kTasks[task].operation;
+                result.implementation = "parutil";
+                result.size = benchTaskSpec.size;
+                result.destinationOffset = 0;
+                result.sourceOffset = 0;
+                result.numThreads = numThreads;
+                result.numaNode = numaNode;
+                result.repetitions = benchTaskSpec.rounds;
+                result.nsBest = benchTaskSpec.nsBest;
+                result.nsMean = benchTaskSpec.nsTotal / (double)benchTaskSpec.rounds;
+                result.unit = kTasks[task].unit;
+                result.valid = benchTaskSpec.valid;
+
+                // Scheduler results are the time each thread spends per call.
+                // Each thread calls the static scheduler a fixed number of times, whereas dynamic scheduler calls, one per unit, are divided among all threads.
+                if (ParutilBenchTaskKindSchedulerStatic == kTasks[task].kind)
+                    result.value = result.nsBest / (double)kParutilBenchSchedulerStaticCallsPerRound;
+                else if (ParutilBenchTaskKindSchedulerDynamic == kTasks[task].kind)
+                    result.value = (result.nsBest * (double)numThreads) / (double)benchTaskSpec.size;
+                else
+                    result.value = ((double)benchTaskSpec.size * (double)numThreads * 1.0e3) / result.nsBest;
+
+                allValid = allValid && result.valid;
+                parutilBenchOutputResult(output, &result);
+            }
+        }
+
+        parutilBenchFree(threadSlots, threadSlotsSize);
+    }
+
+    return allValid;
+}
+
+/// Prints usage information.
+/// @param [in] programName Name used to invoke the program.
+static void parutilBenchUsage(const char* programName)
+{
+    fprintf(stderr, "Usage: %s [options]\n", programName);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "    -f, --format csv|json\n");
+    fprintf(stderr, "        Output format. Default is csv.\n");
+    fprintf(stderr, "    -o, --output FILE\n");
+    fprintf(stderr, "        Writes results to FILE instead of standard output.\n");
+    fprintf(stderr, "    -s, --max-size BYTES\n");
+    fprintf(stderr, "        Largest buffer size for memory benchmarks. Default is %llu.\n", (unsigned long long)kParutilBenchMemoryDefaultMaximumSize);
+    fprintf(stderr, "    -t, --max-threads N\n");
+    fprintf(stderr, "        Largest number of threads per NUMA node for scheduler and atomic benchmarks. Default is all processors.\n");
+    fprintf(stderr, "    -m, --memory-only\n");
+    fprintf(stderr, "        Runs only the memory benchmarks.\n");
+    fprintf(stderr, "    -x, --no-memory\n");
+    fprintf(stderr, "        Runs only the scheduler and atomic benchmarks.\n");
+    fprintf(stderr, "    -h, --help\n");
+    fprintf(stderr, "        Shows this information.\n");
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Progress is reported on standard error. Exit status is non-zero if any result fails its correctness check.\n");
+}
+
+
+// -------- FUNCTIONS ------------------------------------------------------ //
+
+int main(int argc, char* argv[])
+{
+    static const struct option kLongOptions[] = {
+        {"format", required_argument, NULL, 'f'},
+        {"output", required_argument, NULL, 'o'},
+        {"max-size", required_argument, NULL, 's'},
+        {"max-threads", required_argument, NULL, 't'},
+        {"memory-only", no_argument, NULL, 'm'},
+        {"no-memory", no_argument, NULL, 'x'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    SParutilBenchOutput output;
+    const char* outputFilename = NULL;
+    size_t maximumSize = kParutilBenchMemoryDefaultMaximumSize;
+    uint32_t maximumThreads = 0;
+    bool runMemory = true;
+    bool runTasks = true;
+    bool allValid = true;
+    int option;
+
+    output.stream = stdout;
+    output.format = ParutilBenchFormatCSV;
+    output.numResults = 0;
+
+    while (-1 != (option = getopt_long(argc, argv, "f:o:s:t:mxh", kLongOptions, NULL)))
+    {
+        switch (option)
+        {
+        case 'f':
+            if (0 == strcmp(optarg, "csv"))
+                output.format = ParutilBenchFormatCSV;
+            else if (0 == strcmp(optarg, "json"))
+                output.format = ParutilBenchFormatJSON;
+            else
+            {
+                parutilBenchUsage(argv[0]);
+                return 2;
+            }
+            break;
+
+        case 'o':
+            outputFilename = optarg;
+            break;
+
+        case 's':
+            maximumSize = (size_t)strtoull(optarg, NULL, 0);
+            if (maximumSize < kParutilBenchMemoryMinimumSize)
+                maximumSize = kParutilBenchMemoryMinimumSize;
+            break;
+
+        case 't':
+            maximumThreads = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+
+        case 'm':
+            runTasks = false;
+            break;
+
+        case 'x':
+            runMemory = false;
+            break;
+
+        case 'h':
+            parutilBenchUsage(argv[0]);
+            return 0;
+
+        default:
+            parutilBenchUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (NULL != outputFilename)
+    {
+        output.stream = fopen(outputFilename, "w");
+
+        if (NULL == output.stream)
+        {
+            fprintf(stderr, "parutil-bench: unable to open %s for writing.\n", outputFilename);
+            return 1;
+        }
+    }
+
+    parutilBenchOutputBegin(&output);
+
+    if (runMemory)
+        allValid = parutilBenchMemory(&output, maximumSize) && allValid;
+
+    if (runTasks)
+        allValid = parutilBenchTasks(&output, maximumThreads) && allValid;
+
+    parutilBenchOutputEnd(&output);
+
+    if (NULL != outputFilename)
+        fclose(output.stream);
+
+    if (!allValid)
+        fprintf(stderr, "parutil-bench: one or more results failed their correctness checks.\n");
+
+    return (allValid ? 0 : 1);
+}
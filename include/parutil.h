@@ -35,6 +35,63 @@ typedef enum EParutilStaticScheduler
     ParutilStaticSchedulerChunked,                                          ///< Chunked scheduler, which creates one continuous chunk of work per thread.
 } EParutilStaticScheduler;
 
+/// Enumerates the operations for which Parutil collects statistics.
+/// Used to index the per-operation statistics in #SParutilStats.
+typedef enum EParutilStatsOperation
+{
+    ParutilStatsOperationMemoryChecksum,                                    ///< #parutilMemoryChecksum
+    ParutilStatsOperationMemoryCopy,                                        ///< #parutilMemoryCopy
+    ParutilStatsOperationMemoryCopyChecksum,                                ///< #parutilMemoryCopyChecksum
+    ParutilStatsOperationMemoryFilter,                                      ///< #parutilMemoryFilter
+    ParutilStatsOperationMemoryGather32,                                    ///< #parutilMemoryGather32
+    ParutilStatsOperationMemoryGather64,                                    ///< #parutilMemoryGather64
+    ParutilStatsOperationMemoryScatter32,                                   ///< #parutilMemoryScatter32
+    ParutilStatsOperationMemoryScatter64,                                   ///< #parutilMemoryScatter64
+    ParutilStatsOperationMemorySet,                                         ///< #parutilMemorySet
+    ParutilStatsOperationPartitionRadix,                                    ///< #parutilPartitionRadix
+    ParutilStatsOperationCount,                                             ///< Number of operations for which statistics are collected. Not a valid operation.
+} EParutilStatsOperation;
+
+/// Number of size classes tracked for each operation.
+/// Size class `i` counts calls that process at least `2^i` and fewer than `2^(i+1)` bytes, and size class 0 additionally counts calls that process no bytes.
+#define PARUTIL_STATS_NUM_SIZE_CLASSES                                      64
+
+/// Number of per-thread statistics slots.
+/// Each thread claims a free slot other than slot 0 the first time it records statistics, keeps it until it exits, and then releases it for use by other threads.
+/// Statistics for a slot therefore accumulate over every thread that has held it.
+/// Threads that find no free slot share slot 0, which is the only slot updated using atomic operations.
+#define PARUTIL_STATS_NUM_THREAD_SLOTS                                      256
+
+/// Holds statistics for a single operation.
+/// Timing is measured using the processor's time-stamp counter, so cycle counts are converted to time using #SParutilStats::tscFrequencyHz.
+typedef struct SParutilStatsOperation
+{
+    uint64_t numCalls;                                                      ///< Number of calls.
+    uint64_t numSerialCalls;                                                ///< Number of calls small enough to be handled by a single thread without parallelization.
+    uint64_t numUnalignedCalls;                                             ///< Number of parallelized calls that used a slower implementation because of buffer alignment. Applies to copy operations whose buffers are not both 32-byte aligned and to radix partitioning whose destination is not aligned to the record size.
+    uint64_t numSpawns;                                                     ///< Number of calls made outside of a Spindle parallelized region, which spawned a new Spindle task.
+    uint64_t numBytes;                                                      ///< Total number of bytes processed.
+    uint64_t numCycles;                                                     ///< Total number of cycles spent within calls.
+    uint64_t numSpawnCycles;                                                ///< Total number of cycles between spawning a new Spindle task and the first thread of that task starting work.
+    uint64_t numCallsBySizeClass[PARUTIL_STATS_NUM_SIZE_CLASSES];           ///< Number of calls in each size class.
+} SParutilStatsOperation;
+
+/// Holds scheduling assistance statistics for a single thread.
+typedef struct SParutilStatsScheduler
+{
+    uint64_t numStaticCalls;                                                ///< Number of calls to #parutilSchedulerStatic.
+    uint64_t numDynamicInitCalls;                                           ///< Number of calls to #parutilSchedulerDynamicInit.
+    uint64_t numDynamicGetWorkCalls;                                        ///< Number of calls to #parutilSchedulerDynamicGetWork.
+} SParutilStatsScheduler;
+
+/// Communicates a snapshot of the statistics Parutil collects when built with statistics enabled.
+typedef struct SParutilStats
+{
+    SParutilStatsOperation operations[ParutilStatsOperationCount];          ///< Per-operation statistics, summed over all threads.
+    SParutilStatsScheduler scheduler[PARUTIL_STATS_NUM_THREAD_SLOTS];       ///< Per-thread scheduling assistance statistics, indexed by statistics slot.
+    uint64_t tscFrequencyHz;                                                ///< Frequency of the time-stamp counter, in Hz. Dividing a cycle count by this value gives the time in seconds, and dividing a number of bytes by the resulting time gives throughput.
+} SParutilStats;
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -125,6 +182,17 @@ uint64_t parutilAtomicExchangeAdd64(uint64_t* const ptr, const uint64_t incr);
 
 // -------- FUNCTIONS: MEMORY ---------------------------------------------- //
 
+/// Computes the CRC32C (Castagnoli) checksum of `num` bytes of memory at `buffer`.
+/// The checksum uses the standard initial value and final complement, so it matches the iSCSI and SSE4.2 definitions of CRC32C.
+/// If called from within a Spindle parallelized region, every thread in the same task must invoke this function with the same arguments, and every thread receives the checksum.
+/// If not, uses all available hardware threads on the NUMA node of the buffer.
+/// Reverts to a single-threaded implementation if `num` is small enough.
+/// @param [in] buffer Source memory buffer.
+/// @param [in] num Number of bytes to checksum.
+/// @param [out] checksum Checksum of the buffer, provided as output.
+/// @return `true` if successful, `false` otherwise.
+bool parutilMemoryChecksum(const void* buffer, size_t num, uint32_t* const checksum);
+
 /// Copies `num` bytes of memory at `source` to memory at `destination`.
 /// Intended to be a drop-in replacement for the standard `memcpy()` function.
 /// It is the caller's responsibility to ensure that `source` and `destination` regions do not overlap.
@@ -137,6 +205,19 @@ uint64_t parutilAtomicExchangeAdd64(uint64_t* const ptr, const uint64_t incr);
 /// @return `destination` is returned upon completion.
 void* parutilMemoryCopy(void* destination, const void* source, size_t num);
 
+/// Copies `num` bytes of memory at `source` to memory at `destination` and computes the CRC32C checksum of the copied data in the same pass.
+/// The resulting checksum is identical to the one computed by #parutilMemoryChecksum.
+/// It is the caller's responsibility to ensure that `source` and `destination` regions do not overlap.
+/// If called from within a Spindle parallelized region, every thread in the same task must invoke this function with the same arguments, and every thread receives the checksum.
+/// If not, uses all available hardware threads on the NUMA node of the destination buffer.
+/// Reverts to a single-threaded implementation if `num` is small enough.
+/// @param [in] destination Target memory buffer.
+/// @param [in] source Source memory buffer.
+/// @param [in] num Number of bytes to copy.
+/// @param [out] checksum Checksum of the copied data, provided as output. Must not be `NULL`.
+/// @return `destination` is returned upon completion, or `NULL` on failure, including if `checksum` is `NULL`.
+void* parutilMemoryCopyChecksum(void* destination, const void* source, size_t num, uint32_t* const checksum);
+
 /// Filters `num` bytes of memory at `buffer` by performing bitwise-and with the value specified by `value`.
 /// If called from within a Spindle parallelized region, every thread in the same task must invoke this function with the same arguments.
 /// If not, uses all available hardware threads on the NUMA node of the destination buffer.
@@ -147,6 +228,60 @@ void* parutilMemoryCopy(void* destination, const void* source, size_t num);
 /// @return `buffer` is returned upon completion.
 void* parutilMemoryFilter(void* buffer, uint8_t value, size_t num);
 
+/// Gathers `num` 32-bit elements from `source` into `destination` according to `indices`, such that `destination[i] = source[indices[i]]`.
+/// All arrays must be aligned to the size of their elements, and every index must be less than 2^31.
+/// It is the caller's responsibility to ensure that `destination` does not overlap with either `source` or `indices`.
+/// If called from within a Spindle parallelized region, every thread in the same task must invoke this function with the same arguments.
+/// If not, uses all available hardware threads on the NUMA node of the destination buffer.
+/// Reverts to a simple loop if `num` is small enough.
+/// @param [in] destination Target memory buffer.
+/// @param [in] source Source memory buffer.
+/// @param [in] indices Indices of the source elements to gather.
+/// @param [in] num Number of elements to gather.
+/// @return `destination` is returned upon completion.
+uint32_t* parutilMemoryGather32(uint32_t* destination, const uint32_t* source, const uint32_t* indices, size_t num);
+
+/// Gathers `num` 64-bit elements from `source` into `destination` according to `indices`, such that `destination[i] = source[indices[i]]`.
+/// All arrays must be aligned to the size of their elements, and every index must be less than 2^63.
+/// It is the caller's responsibility to ensure that `destination` does not overlap with either `source` or `indices`.
+/// If called from within a Spindle parallelized region, every thread in the same task must invoke this function with the same arguments.
+/// If not, uses all available hardware threads on the NUMA node of the destination buffer.
+/// Reverts to a simple loop if `num` is small enough.
+/// @param [in] destination Target memory buffer.
+/// @param [in] source Source memory buffer.
+/// @param [in] indices Indices of the source elements to gather.
+/// @param [in] num Number of elements to gather.
+/// @return `destination` is returned upon completion.
+uint64_t* parutilMemoryGather64(uint64_t* destination, const uint64_t* source, const uint64_t* indices, size_t num);
+
+/// Scatters `num` 32-bit elements from `source` into `destination` according to `indices`, such that `destination[indices[i]] = source[i]`.
+/// All arrays must be aligned to the size of their elements.
+/// If `indices` contains duplicates, which of the corresponding source elements is written is unspecified.
+/// It is the caller's responsibility to ensure that `destination` does not overlap with either `source` or `indices`.
+/// If called from within a Spindle parallelized region, every thread in the same task must invoke this function with the same arguments.
+/// If not, uses all available hardware threads on the NUMA node of the destination buffer.
+/// Reverts to a simple loop if `num` is small enough.
+/// @param [in] destination Target memory buffer.
+/// @param [in] source Source memory buffer.
+/// @param [in] indices Indices of the destination elements to write.
+/// @param [in] num Number of elements to scatter.
+/// @return `destination` is returned upon completion.
+uint32_t* parutilMemoryScatter32(uint32_t* destination, const uint32_t* source, const uint32_t* indices, size_t num);
+
+/// Scatters `num` 64-bit elements from `source` into `destination` according to `indices`, such that `destination[indices[i]] = source[i]`.
+/// All arrays must be aligned to the size of their elements.
+/// If `indices` contains duplicates, which of the corresponding source elements is written is unspecified.
+/// It is the caller's responsibility to ensure that `destination` does not overlap with either `source` or `indices`.
+/// If called from within a Spindle parallelized region, every thread in the same task must invoke this function with the same arguments.
+/// If not, uses all available hardware threads on the NUMA node of the destination buffer.
+/// Reverts to a simple loop if `num` is small enough.
+/// @param [in] destination Target memory buffer.
+/// @param [in] source Source memory buffer.
+/// @param [in] indices Indices of the destination elements to write.
+/// @param [in] num Number of elements to scatter.
+/// @return `destination` is returned upon completion.
+uint64_t* parutilMemoryScatter64(uint64_t* destination, const uint64_t* source, const uint64_t* indices, size_t num);
+
 /// Sets `num` bytes of memory at `buffer` to the value specified by `value`.
 /// Intended to be a drop-in replacement for the standard `memset()` function.
 /// If called from within a Spindle parallelized region, every thread in the same task must invoke this function with the same arguments.
@@ -159,6 +294,28 @@ void* parutilMemoryFilter(void* buffer, uint8_t value, size_t num);
 void* parutilMemorySet(void* buffer, uint8_t value, size_t num);
 
 
+// -------- FUNCTIONS: PARTITION ------------------------------------------- //
+
+/// Partitions `numRecords` fixed-width records at `source` into `2^radixBits` partitions, which are written one after the other to `destination`.
+/// The partition of each record is determined by bits `radixShift` through `radixShift + radixBits - 1` of the 64-bit key located `keyOffset` bytes into the record.
+/// Records retain their relative order from `source` within each partition.
+/// Supported record sizes are 8, 16, 32, and 64 bytes, `keyOffset` must be a multiple of 8, and the key must lie entirely within the record.
+/// It is the caller's responsibility to ensure that `source` and `destination` regions do not overlap.
+/// If called from within a Spindle parallelized region, every thread in the same task must invoke this function with the same arguments.
+/// If not, uses all available hardware threads on the NUMA node of the destination buffer.
+/// Reverts to a single-threaded implementation if the total size of the records is small enough.
+/// @param [in] destination Target memory buffer, which must be large enough to hold `numRecords` records.
+/// @param [in] source Source memory buffer.
+/// @param [in] recordSize Size of each record, in bytes.
+/// @param [in] numRecords Number of records to partition.
+/// @param [in] keyOffset Byte offset of the 64-bit key within each record.
+/// @param [in] radixShift Position of the least-significant key bit used to identify the partition.
+/// @param [in] radixBits Number of key bits used to identify the partition, between 1 and 12 inclusive.
+/// @param [out] partitionOffsets Optional array of `2^radixBits + 1` elements, filled with the index of the first record of each partition in `destination` followed by `numRecords`. May be `NULL`.
+/// @return `true` if successful, `false` if a parameter is invalid or memory could not be allocated.
+bool parutilPartitionRadix(void* destination, const void* source, const size_t recordSize, const size_t numRecords, const size_t keyOffset, const uint8_t radixShift, const uint8_t radixBits, size_t* const partitionOffsets);
+
+
 // -------- FUNCTIONS: SCHEDULER ------------------------------------------- //
 
 /// Uses a static scheduler of the specified type to provide the caller with information on assigned work.
@@ -203,6 +360,21 @@ uint64_t parutilSchedulerDynamicGetWork(void* schedule);
 void parutilSchedulerDynamicExit(void* schedule);
 
 
+// -------- FUNCTIONS: STATISTICS ------------------------------------------ //
+
+/// Captures a snapshot of the statistics collected so far.
+/// Statistics are only collected if Parutil is built with `PARUTIL_STATS` defined, in which case memory operations and scheduling assistance functions update low-overhead per-thread counters.
+/// Counters are read without synchronization, so a snapshot taken while other threads are calling Parutil functions is approximate.
+/// The first snapshot also measures the time-stamp counter frequency, which takes a few milliseconds.
+/// @param [out] stats Statistics snapshot, provided as output.
+/// @return `true` if successful, `false` if statistics are not being collected or the output parameter is `NULL`.
+bool parutilStatsSnapshot(SParutilStats* const stats);
+
+/// Resets all statistics collected so far to zero.
+/// Intended to be called while no other threads are calling Parutil functions. Has no effect if statistics are not being collected.
+void parutilStatsReset(void);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -19,6 +19,15 @@
 
 // -------- FUNCTIONS ------------------------------------------------------ //
 
+/// Computes the partial CRC32C checksum of `num64` 64-byte blocks of memory at `buffer`.
+/// Intended to be called from within the context of a Spindle parallelized region.
+/// Work is statically scheduled and distributed across all active threads.
+/// Each thread computes the checksum of its own chunk, starting from zero, and the results must be combined in chunk order.
+/// @param [in] buffer Source memory buffer.
+/// @param [in] num64 Number of 64-byte blocks to checksum.
+/// @return Checksum of the chunk of memory assigned to the calling thread.
+uint32_t parutilMemoryChecksumThread(const void* buffer, size_t num64);
+
 /// Copies `num64` properly-aligned 64-byte blocks of memory from `destination` to `source`.
 /// Intended to be called from within the context of a Spindle parallelized region.
 /// Work is statically scheduled and distributed across all active threads.
@@ -36,6 +45,27 @@ void parutilMemoryCopyAlignedThread(void* destination, const void* source, size_
 /// @param [in] num64 Number of 64-byte blocks to copy.
 void parutilMemoryCopyUnalignedThread(void* destination, const void* source, size_t num64);
 
+/// Copies `num64` properly-aligned 64-byte blocks of memory from `destination` to `source` and computes the partial CRC32C checksum of the copied data.
+/// Intended to be called from within the context of a Spindle parallelized region.
+/// Work is statically scheduled and distributed across all active threads.
+/// Each thread computes the checksum of its own chunk, starting from zero, and the results must be combined in chunk order.
+/// @param [in] destination Target memory buffer.
+/// @param [in] source Source memory buffer.
+/// @param [in] num64 Number of 64-byte blocks to copy.
+/// @return Checksum of the chunk of memory assigned to the calling thread.
+uint32_t parutilMemoryCopyChecksumAlignedThread(void* destination, const void* source, size_t num64);
+
+/// Copies `num64` 64-byte blocks of memory from `destination` to `source` and computes the partial CRC32C checksum of the copied data.
+/// No assumptions are made as to their alignment.
+/// Intended to be called from within the context of a Spindle parallelized region.
+/// Work is statically scheduled in 8-byte units and distributed across all active threads.
+/// Each thread computes the checksum of its own chunk, starting from zero, and the results must be combined in chunk order.
+/// @param [in] destination Target memory buffer.
+/// @param [in] source Source memory buffer.
+/// @param [in] num64 Number of 64-byte blocks to copy.
+/// @return Checksum of the chunk of memory assigned to the calling thread.
+uint32_t parutilMemoryCopyChecksumUnalignedThread(void* destination, const void* source, size_t num64);
+
 /// Filters `num64` properly-aligned 64-byte blocks of memory by performing bitwise-and with `value`.
 /// Intended to be called from within the context of a Spindle parallelized region.
 /// Work is statically scheduled and distributed across all active threads.
@@ -44,6 +74,44 @@ void parutilMemoryCopyUnalignedThread(void* destination, const void* source, siz
 /// @param [in] num64 Number of 64-byte blocks to initialize.
 void parutilMemoryFilterAlignedThread(void* buffer, uint64_t value, size_t num64);
 
+/// Gathers `num64` 64-byte blocks of 32-bit elements from `source` into `destination`, such that `destination[i] = source[indices[i]]`.
+/// Destination must be aligned on a 64-byte boundary.
+/// Intended to be called from within the context of a Spindle parallelized region.
+/// Work is statically scheduled and distributed across all active threads.
+/// @param [in] destination Target memory buffer.
+/// @param [in] source Source memory buffer.
+/// @param [in] indices Indices of the source elements to gather.
+/// @param [in] num64 Number of 64-byte blocks of destination elements to gather.
+void parutilMemoryGather32Thread(uint32_t* destination, const uint32_t* source, const uint32_t* indices, size_t num64);
+
+/// Gathers `num64` 64-byte blocks of 64-bit elements from `source` into `destination`, such that `destination[i] = source[indices[i]]`.
+/// Destination must be aligned on a 64-byte boundary.
+/// Intended to be called from within the context of a Spindle parallelized region.
+/// Work is statically scheduled and distributed across all active threads.
+/// @param [in] destination Target memory buffer.
+/// @param [in] source Source memory buffer.
+/// @param [in] indices Indices of the source elements to gather.
+/// @param [in] num64 Number of 64-byte blocks of destination elements to gather.
+void parutilMemoryGather64Thread(uint64_t* destination, const uint64_t* source, const uint64_t* indices, size_t num64);
+
+/// Scatters `num64` 64-byte blocks of 32-bit elements from `source` into `destination`, such that `destination[indices[i]] = source[i]`.
+/// Intended to be called from within the context of a Spindle parallelized region.
+/// Work is statically scheduled and distributed across all active threads.
+/// @param [in] destination Target memory buffer.
+/// @param [in] source Source memory buffer.
+/// @param [in] indices Indices of the destination elements to write.
+/// @param [in] num64 Number of 64-byte blocks of source elements to scatter.
+void parutilMemoryScatter32Thread(uint32_t* destination, const uint32_t* source, const uint32_t* indices, size_t num64);
+
+/// Scatters `num64` 64-byte blocks of 64-bit elements from `source` into `destination`, such that `destination[indices[i]] = source[i]`.
+/// Intended to be called from within the context of a Spindle parallelized region.
+/// Work is statically scheduled and distributed across all active threads.
+/// @param [in] destination Target memory buffer.
+/// @param [in] source Source memory buffer.
+/// @param [in] indices Indices of the destination elements to write.
+/// @param [in] num64 Number of 64-byte blocks of source elements to scatter.
+void parutilMemoryScatter64Thread(uint64_t* destination, const uint64_t* source, const uint64_t* indices, size_t num64);
+
 /// Sets `num64` properly-aligned 64-byte blocks of memory to `value`.
 /// Intended to be called from within the context of a Spindle parallelized region.
 /// Work is statically scheduled and distributed across all active threads.
@@ -0,0 +1,28 @@
+/*****************************************************************************
+ * Parutil
+ *   Multi-platform library of parallelized utility functions.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Department of Electrical Engineering, Stanford University
+ * Copyright (c) 2016-2017
+ *************************************************************************//**
+ * @file scheduler.h
+ *   Declaration of internal scheduling assistance functionality.
+ *   Not intended for external use.
+ *****************************************************************************/
+
+#pragma once
+
+#include "../parutil.h"
+
+#include <stdint.h>
+
+
+// -------- FUNCTIONS ------------------------------------------------------ //
+
+/// Internal initializaton function for a static chunked scheduler.
+/// Unlike #parutilSchedulerStatic, performs no checks and is not counted in statistics, so it is suitable for use within Parutil itself.
+/// Intended to be called from within the context of a Spindle parallelized region.
+/// @param [in] units Total number of units of work that need to be scheduled.
+/// @param [out] schedule Scheduling information, provided as output.
+void parutilSchedulerStaticChunkedInternal(const uint64_t units, SParutilStaticSchedule* const schedule);
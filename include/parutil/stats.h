@@ -0,0 +1,189 @@
+/*****************************************************************************
+ * Parutil
+ *   Multi-platform library of parallelized utility functions.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Department of Electrical Engineering, Stanford University
+ * Copyright (c) 2016-2017
+ *************************************************************************//**
+ * @file stats.h
+ *   Declaration of internal statistics collection functionality.
+ *   Not intended for external use.
+ *   Unless `PARUTIL_STATS` is defined, all functions in this file do nothing and are optimized away.
+ *****************************************************************************/
+
+#pragma once
+
+#include "../parutil.h"
+
+#include <spindle.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef PARUTIL_STATS
+#ifdef PARUTIL_WINDOWS
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+
+// -------- CONSTANTS ------------------------------------------------------ //
+
+#ifdef PARUTIL_WINDOWS
+/// Storage class specifier for thread-local variables.
+#define PARUTIL_STATS_THREAD_LOCAL                                          __declspec(thread)
+#else
+/// Storage class specifier for thread-local variables.
+#define PARUTIL_STATS_THREAD_LOCAL                                          _Thread_local
+#endif
+
+
+// -------- TYPE DEFINITIONS ----------------------------------------------- //
+
+/// Holds all statistics collected by the threads that have held a single slot.
+/// Padded such that different slots never share a cache line, regardless of the alignment of the array of slots.
+/// See #PARUTIL_STATS_NUM_THREAD_SLOTS for how threads are assigned to slots.
+typedef struct SParutilStatsThreadSlot
+{
+    SParutilStatsOperation operations[ParutilStatsOperationCount];          ///< Per-operation statistics.
+    SParutilStatsScheduler scheduler;                                       ///< Scheduling assistance statistics.
+    uint32_t isClaimed;                                                     ///< Non-zero if a thread currently holds this slot. Never set for slot 0.
+    uint8_t padding[64 + (64 - ((sizeof(SParutilStatsOperation) * ParutilStatsOperationCount + sizeof(SParutilStatsScheduler) + sizeof(uint32_t)) & 63))];  ///< Unused.
+} SParutilStatsThreadSlot;
+
+
+// -------- GLOBALS -------------------------------------------------------- //
+
+#ifdef PARUTIL_STATS
+/// Statistics storage, indexed by statistics slot.
+extern SParutilStatsThreadSlot parutilStatsThreadSlots[PARUTIL_STATS_NUM_THREAD_SLOTS];
+
+/// Slot held by the current thread, or `NULL` if the thread has not yet recorded any statistics.
+extern PARUTIL_STATS_THREAD_LOCAL SParutilStatsThreadSlot* parutilStatsCurrentSlot;
+#endif
+
+
+// -------- FUNCTIONS ------------------------------------------------------ //
+
+/// Retrieves the current value of the time-stamp counter.
+/// @return Current time-stamp counter value, or 0 if statistics are not being collected.
+static inline uint64_t parutilStatsTimestamp(void)
+{
+#ifdef PARUTIL_STATS
+    return (uint64_t)__rdtsc();
+#else
+    return 0ull;
+#endif
+}
+
+#ifdef PARUTIL_STATS
+/// Claims a slot for the current thread and stores it in #parutilStatsCurrentSlot.
+/// Called the first time a thread records statistics. Falls back to the shared slot 0 if no other slot is free.
+/// @return Slot claimed for the current thread.
+SParutilStatsThreadSlot* parutilStatsClaimSlot(void);
+
+/// Identifies the statistics slot of the calling thread, claiming one if needed.
+/// @return Statistics slot held by the calling thread.
+static inline SParutilStatsThreadSlot* parutilStatsGetSlot(void)
+{
+    SParutilStatsThreadSlot* slot = parutilStatsCurrentSlot;
+
+    if (NULL == slot)
+        slot = parutilStatsClaimSlot();
+
+    return slot;
+}
+
+/// Adds a value to a statistics counter belonging to the specified slot.
+/// Only slot 0 can be written by multiple threads at once, so only its counters are updated atomically.
+/// @param [in] slot Statistics slot to which the counter belongs.
+/// @param [in,out] counter Counter to update.
+/// @param [in] value Value to add to the counter.
+static inline void parutilStatsAdd(const SParutilStatsThreadSlot* const slot, uint64_t* const counter, const uint64_t value)
+{
+    if (&parutilStatsThreadSlots[0] == slot)
+        parutilAtomicAdd64(counter, value);
+    else
+        *counter += value;
+}
+#endif
+
+/// Records the completion of a call to an operation.
+/// If called from within a Spindle parallelized region, only the first thread in the task records the call.
+/// @param [in] operation Operation that was called.
+/// @param [in] numBytes Number of bytes processed by the call.
+/// @param [in] startTimestamp Time-stamp counter value at the start of the call, as obtained from #parutilStatsTimestamp.
+/// @param [in] isSerial Whether or not the call was handled by a single thread without parallelization.
+/// @param [in] isUnaligned Whether or not the call used an unaligned implementation.
+static inline void parutilStatsRecordOperation(const EParutilStatsOperation operation, const size_t numBytes, const uint64_t startTimestamp, const bool isSerial, const bool isUnaligned)
+{
+#ifdef PARUTIL_STATS
+    const uint64_t endTimestamp = parutilStatsTimestamp();
+    const bool isInParallelRegion = spindleIsInParallelRegion();
+    uint32_t sizeClass = 0;
+
+    if (isInParallelRegion && (0 != spindleGetLocalThreadID()))
+        return;
+
+    for (size_t remainingBytes = numBytes; remainingBytes > 1; remainingBytes >>= 1)
+        sizeClass += 1;
+
+    {
+        SParutilStatsThreadSlot* const slot = parutilStatsGetSlot();
+        SParutilStatsOperation* const stats = &slot->operations[operation];
+
+        parutilStatsAdd(slot, &stats->numCalls, 1ull);
+        parutilStatsAdd(slot, &stats->numBytes, (uint64_t)numBytes);
+        parutilStatsAdd(slot, &stats->numCycles, endTimestamp - startTimestamp);
+        parutilStatsAdd(slot, &stats->numCallsBySizeClass[sizeClass], 1ull);
+
+        if (isSerial)
+            parutilStatsAdd(slot, &stats->numSerialCalls, 1ull);
+        else if (!isInParallelRegion)
+            parutilStatsAdd(slot, &stats->numSpawns, 1ull);
+
+        if (isUnaligned)
+            parutilStatsAdd(slot, &stats->numUnalignedCalls, 1ull);
+    }
+#endif
+}
+
+/// Records a call to #parutilSchedulerStatic.
+/// Intended to be called from within a Spindle parallelized region.
+static inline void parutilStatsRecordSchedulerStatic(void)
+{
+#ifdef PARUTIL_STATS
+    SParutilStatsThreadSlot* const slot = parutilStatsGetSlot();
+    parutilStatsAdd(slot, &slot->scheduler.numStaticCalls, 1ull);
+#endif
+}
+
+/// Records a call to #parutilSchedulerDynamicInit.
+/// Intended to be called from within a Spindle parallelized region.
+static inline void parutilStatsRecordSchedulerDynamicInit(void)
+{
+#ifdef PARUTIL_STATS
+    SParutilStatsThreadSlot* const slot = parutilStatsGetSlot();
+    parutilStatsAdd(slot, &slot->scheduler.numDynamicInitCalls, 1ull);
+#endif
+}
+
+/// Records a call to #parutilSchedulerDynamicGetWork.
+/// Intended to be called from within a Spindle parallelized region.
+static inline void parutilStatsRecordSchedulerDynamicGetWork(void)
+{
+#ifdef PARUTIL_STATS
+    SParutilStatsThreadSlot* const slot = parutilStatsGetSlot();
+    parutilStatsAdd(slot, &slot->scheduler.numDynamicGetWorkCalls, 1ull);
+#endif
+}
+
+/// Spawns a single Spindle task, as would `spindleThreadsSpawn`, and records the time taken for the first thread of the task to start work.
+/// Intended to be called in place of `spindleThreadsSpawn` when dispatching an operation from outside of a Spindle parallelized region.
+/// @param [in] taskSpec Specification of the task to spawn.
+/// @param [in] operation Operation being dispatched.
+/// @return Result of `spindleThreadsSpawn`.
+uint32_t parutilStatsThreadsSpawn(SSpindleTaskSpec* taskSpec, const EParutilStatsOperation operation);
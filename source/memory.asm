@@ -18,9 +18,135 @@ INCLUDE spindle.inc
 _TEXT                                       SEGMENT
 
 
+; --------- CONSTANTS ---------------------------------------------------------
+
+; Number of 64-byte blocks ahead of the current block for which indexed memory operations issue software prefetches.
+kParutilMemoryIndexedPrefetchDistance       EQU         4
+
+
+; --------- MACROS ------------------------------------------------------------
+
+; Issues software prefetches for the 32-bit elements referenced by a 64-byte block of 32-bit indices.
+; Clobbers: rdx
+; Parameters:
+;    - r_pfdata holds the base address of the array of elements being indexed
+;    - r_pfindices holds the address of the 64-byte block of indices
+parutilMemoryPrefetchIndexed32              MACRO r_pfdata, r_pfindices
+    mov                     edx,                    DWORD PTR [r_pfindices+0]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+4]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+8]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+12]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+16]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+20]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+24]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+28]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+32]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+36]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+40]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+44]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+48]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+52]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+56]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+    mov                     edx,                    DWORD PTR [r_pfindices+60]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*4]
+ENDM
+
+; Issues software prefetches for the 64-bit elements referenced by a 64-byte block of 64-bit indices.
+; Clobbers: rdx
+; Parameters:
+;    - r_pfdata holds the base address of the array of elements being indexed
+;    - r_pfindices holds the address of the 64-byte block of indices
+parutilMemoryPrefetchIndexed64              MACRO r_pfdata, r_pfindices
+    mov                     rdx,                    QWORD PTR [r_pfindices+0]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*8]
+    mov                     rdx,                    QWORD PTR [r_pfindices+8]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*8]
+    mov                     rdx,                    QWORD PTR [r_pfindices+16]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*8]
+    mov                     rdx,                    QWORD PTR [r_pfindices+24]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*8]
+    mov                     rdx,                    QWORD PTR [r_pfindices+32]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*8]
+    mov                     rdx,                    QWORD PTR [r_pfindices+40]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*8]
+    mov                     rdx,                    QWORD PTR [r_pfindices+48]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*8]
+    mov                     rdx,                    QWORD PTR [r_pfindices+56]
+    prefetcht0              BYTE PTR [r_pfdata+rdx*8]
+ENDM
+
+
 ; --------- FUNCTIONS ---------------------------------------------------------
 ; See "memory.h" for documentation.
 
+parutilMemoryChecksumThread                 PROC PUBLIC
+    ; Save non-volatile registers.
+    push                    rbx
+    push                    rsi
+    push                    rdi
+    push                    r12
+    push                    r13
+    
+    ; Set aside the original parameters.
+    mov                     r12,                    r64_param1
+    mov                     r13,                    r64_param2
+    
+    ; Initialize.
+    ; The checksum of this thread's chunk starts from zero and is later combined with the checksums of all other chunks.
+    parutilSchedulerInitStaticChunk
+    xor                     rax,                    rax
+    
+    ; Perform the checksum operation assigned to this thread.
+  parutilMemoryChecksumThreadLoop:
+    cmp                     rsi,                    rdi
+    jge                     parutilMemoryChecksumThreadDone
+    
+    ; Compute the byte offset of the 64-byte block.
+    ; This is equal to the iteration index multiplied by 64, or left-shifted by 6.
+    mov                     rcx,                    rsi
+    shl                     rcx,                    6
+    
+    ; Update the checksum, one 64-bit integer at a time.
+    crc32                   rax,                    QWORD PTR [r12+rcx]
+    crc32                   rax,                    QWORD PTR [r12+rcx+8]
+    crc32                   rax,                    QWORD PTR [r12+rcx+16]
+    crc32                   rax,                    QWORD PTR [r12+rcx+24]
+    crc32                   rax,                    QWORD PTR [r12+rcx+32]
+    crc32                   rax,                    QWORD PTR [r12+rcx+40]
+    crc32                   rax,                    QWORD PTR [r12+rcx+48]
+    crc32                   rax,                    QWORD PTR [r12+rcx+56]
+    
+    add                     rsi,                    1
+    jmp                     parutilMemoryChecksumThreadLoop
+  parutilMemoryChecksumThreadDone:
+    
+    ; Restore non-volatile registers and return.
+    pop                     r13
+    pop                     r12
+    pop                     rdi
+    pop                     rsi
+    pop                     rbx
+
+    ret
+parutilMemoryChecksumThread                 ENDP
+
+; ---------
+
 parutilMemoryCopyAlignedThread              PROC PUBLIC
     ; Save non-volatile registers.
     push                    rbx
@@ -123,6 +249,125 @@ parutilMemoryCopyUnalignedThread            ENDP
 
 ; ---------
 
+parutilMemoryCopyChecksumAlignedThread      PROC PUBLIC
+    ; Save non-volatile registers.
+    push                    rbx
+    push                    rsi
+    push                    rdi
+    push                    r11
+    push                    r12
+    push                    r13
+    
+    ; Set aside the original parameters.
+    mov                     r11,                    r64_param1
+    mov                     r12,                    r64_param2
+    mov                     r13,                    r64_param3
+    
+    ; Initialize.
+    ; The checksum of this thread's chunk starts from zero and is later combined with the checksums of all other chunks.
+    parutilSchedulerInitStaticChunk
+    xor                     rax,                    rax
+    
+    ; Perform the memory copy operation assigned to this thread.
+  parutilMemoryCopyChecksumAlignedThreadLoop:
+    cmp                     rsi,                    rdi
+    jge                     parutilMemoryCopyChecksumAlignedThreadDone
+    
+    ; Compute the byte offset of the 64-byte block.
+    ; This is equal to the iteration index multiplied by 64, or left-shifted by 6.
+    mov                     rcx,                    rsi
+    shl                     rcx,                    6
+    
+    ; Load the source block using non-temporal hints, since there is no locality beyond this iteration.
+    vmovntdqa               ymm0,                   YMMWORD PTR [r12+rcx]
+    vmovntdqa               ymm1,                   YMMWORD PTR [r12+rcx+32]
+    
+    ; Update the checksum, one 64-bit integer at a time.
+    ; The source block was just loaded, so these accesses hit in the cache.
+    crc32                   rax,                    QWORD PTR [r12+rcx]
+    crc32                   rax,                    QWORD PTR [r12+rcx+8]
+    crc32                   rax,                    QWORD PTR [r12+rcx+16]
+    crc32                   rax,                    QWORD PTR [r12+rcx+24]
+    crc32                   rax,                    QWORD PTR [r12+rcx+32]
+    crc32                   rax,                    QWORD PTR [r12+rcx+40]
+    crc32                   rax,                    QWORD PTR [r12+rcx+48]
+    crc32                   rax,                    QWORD PTR [r12+rcx+56]
+    
+    ; Write the destination block using non-temporal hints.
+    vmovntdq                YMMWORD PTR [r11+rcx],                          ymm0
+    vmovntdq                YMMWORD PTR [r11+rcx+32],                       ymm1
+    
+    add                     rsi,                    1
+    jmp                     parutilMemoryCopyChecksumAlignedThreadLoop
+  parutilMemoryCopyChecksumAlignedThreadDone:
+    
+    ; Restore non-volatile registers and return.
+    pop                     r13
+    pop                     r12
+    pop                     r11
+    pop                     rdi
+    pop                     rsi
+    pop                     rbx
+
+    ret
+parutilMemoryCopyChecksumAlignedThread      ENDP
+
+; ---------
+
+parutilMemoryCopyChecksumUnalignedThread    PROC PUBLIC
+    ; Save non-volatile registers.
+    push                    rbx
+    push                    rsi
+    push                    rdi
+    push                    r11
+    push                    r12
+    push                    r13
+    
+    ; To translate from 64-byte blocks to 8-byte blocks, multiply the number of blocks by 8.
+    shl                     r64_param3,             3
+    
+    ; Set aside the original parameters.
+    mov                     r11,                    r64_param1
+    mov                     r12,                    r64_param2
+    mov                     r13,                    r64_param3
+    
+    ; Initialize.
+    ; The checksum of this thread's chunk starts from zero and is later combined with the checksums of all other chunks.
+    parutilSchedulerInitStaticChunk
+    xor                     rax,                    rax
+    
+    ; Perform the memory copy operation assigned to this thread.
+  parutilMemoryCopyChecksumUnalignedThreadLoop:
+    cmp                     rsi,                    rdi
+    jge                     parutilMemoryCopyChecksumUnalignedThreadDone
+    
+    ; Compute the byte offset of the 8-byte block.
+    ; This is equal to the iteration index multiplied by 8, or left-shifted by 3.
+    mov                     rcx,                    rsi
+    shl                     rcx,                    3
+    
+    ; Perform the memory-copy operation, one 64-bit integer at a time, and update the checksum while the data is in a register.
+    mov                     rdx,                    QWORD PTR [r12+rcx]
+    crc32                   rax,                    rdx
+    movnti                  QWORD PTR [r11+rcx],    rdx
+    
+    add                     rsi,                    1
+    jmp                     parutilMemoryCopyChecksumUnalignedThreadLoop
+  parutilMemoryCopyChecksumUnalignedThreadDone:
+    
+    ; Restore non-volatile registers and return.
+    pop                     r13
+    pop                     r12
+    pop                     r11
+    pop                     rdi
+    pop                     rsi
+    pop                     rbx
+
+    ret
+parutilMemoryCopyChecksumUnalignedThread    ENDP
+
+; ---------
+
 parutilMemoryFilterAlignedThread            PROC PUBLIC
     ; Save non-volatile registers.
     push                    rbx
@@ -180,6 +425,282 @@ parutilMemoryFilterAlignedThread            ENDP
 
 ; ---------
 
+parutilMemoryGather32Thread                 PROC PUBLIC
+    ; Save non-volatile registers.
+    push                    rbx
+    push                    rsi
+    push                    rdi
+    push                    r11
+    push                    r12
+    push                    r13
+    push                    r14
+    
+    ; Set aside the original parameters.
+    mov                     r11,                    r64_param1
+    mov                     r12,                    r64_param2
+    mov                     r14,                    r64_param3
+    mov                     r13,                    r64_param4
+    
+    ; Initialize.
+    parutilSchedulerInitStaticChunk
+    
+    ; Perform the gather operation assigned to this thread.
+  parutilMemoryGather32ThreadLoop:
+    cmp                     rsi,                    rdi
+    jge                     parutilMemoryGather32ThreadDone
+    
+    ; Prefetch the elements to be gathered a few blocks ahead, provided those blocks are also assigned to this thread.
+    lea                     rax,                    [rsi+kParutilMemoryIndexedPrefetchDistance]
+    cmp                     rax,                    rdi
+    jge                     parutilMemoryGather32ThreadGather
+    shl                     rax,                    6
+    add                     rax,                    r14
+    parutilMemoryPrefetchIndexed32              r12,                    rax
+    
+  parutilMemoryGather32ThreadGather:
+    ; Compute the byte offset of the 64-byte block.
+    ; This is equal to the iteration index multiplied by 64, or left-shifted by 6.
+    ; Each element has the same size as its index, so the offset applies to both the destination and the indices.
+    mov                     rcx,                    rsi
+    shl                     rcx,                    6
+    
+    ; Perform the gather operation.
+    ; Gather instructions clear their mask registers, so the masks must be re-initialized every time.
+    vmovdqu                 ymm2,                   YMMWORD PTR [r14+rcx]
+    vmovdqu                 ymm3,                   YMMWORD PTR [r14+rcx+32]
+    vpcmpeqd                ymm4,                   ymm4,                   ymm4
+    vpcmpeqd                ymm5,                   ymm5,                   ymm5
+    vpgatherdd              ymm0,                   DWORD PTR [r12+ymm2*4],                         ymm4
+    vpgatherdd              ymm1,                   DWORD PTR [r12+ymm3*4],                         ymm5
+    
+    ; Destination is written sequentially with no reuse, so use non-temporal hints.
+    vmovntdq                YMMWORD PTR [r11+rcx],                          ymm0
+    vmovntdq                YMMWORD PTR [r11+rcx+32],                       ymm1
+    
+    add                     rsi,                    1
+    jmp                     parutilMemoryGather32ThreadLoop
+  parutilMemoryGather32ThreadDone:
+    
+    ; Restore non-volatile registers and return.
+    pop                     r14
+    pop                     r13
+    pop                     r12
+    pop                     r11
+    pop                     rdi
+    pop                     rsi
+    pop                     rbx
+
+    ret
+parutilMemoryGather32Thread                 ENDP
+
+; ---------
+
+parutilMemoryGather64Thread                 PROC PUBLIC
+    ; Save non-volatile registers.
+    push                    rbx
+    push                    rsi
+    push                    rdi
+    push                    r11
+    push                    r12
+    push                    r13
+    push                    r14
+    
+    ; Set aside the original parameters.
+    mov                     r11,                    r64_param1
+    mov                     r12,                    r64_param2
+    mov                     r14,                    r64_param3
+    mov                     r13,                    r64_param4
+    
+    ; Initialize.
+    parutilSchedulerInitStaticChunk
+    
+    ; Perform the gather operation assigned to this thread.
+  parutilMemoryGather64ThreadLoop:
+    cmp                     rsi,                    rdi
+    jge                     parutilMemoryGather64ThreadDone
+    
+    ; Prefetch the elements to be gathered a few blocks ahead, provided those blocks are also assigned to this thread.
+    lea                     rax,                    [rsi+kParutilMemoryIndexedPrefetchDistance]
+    cmp                     rax,                    rdi
+    jge                     parutilMemoryGather64ThreadGather
+    shl                     rax,                    6
+    add                     rax,                    r14
+    parutilMemoryPrefetchIndexed64              r12,                    rax
+    
+  parutilMemoryGather64ThreadGather:
+    ; Compute the byte offset of the 64-byte block.
+    ; This is equal to the iteration index multiplied by 64, or left-shifted by 6.
+    ; Each element has the same size as its index, so the offset applies to both the destination and the indices.
+    mov                     rcx,                    rsi
+    shl                     rcx,                    6
+    
+    ; Perform the gather operation.
+    ; Gather instructions clear their mask registers, so the masks must be re-initialized every time.
+    vmovdqu                 ymm2,                   YMMWORD PTR [r14+rcx]
+    vmovdqu                 ymm3,                   YMMWORD PTR [r14+rcx+32]
+    vpcmpeqd                ymm4,                   ymm4,                   ymm4
+    vpcmpeqd                ymm5,                   ymm5,                   ymm5
+    vpgatherqq              ymm0,                   QWORD PTR [r12+ymm2*8],                         ymm4
+    vpgatherqq              ymm1,                   QWORD PTR [r12+ymm3*8],                         ymm5
+    
+    ; Destination is written sequentially with no reuse, so use non-temporal hints.
+    vmovntdq                YMMWORD PTR [r11+rcx],                          ymm0
+    vmovntdq                YMMWORD PTR [r11+rcx+32],                       ymm1
+    
+    add                     rsi,                    1
+    jmp                     parutilMemoryGather64ThreadLoop
+  parutilMemoryGather64ThreadDone:
+    
+    ; Restore non-volatile registers and return.
+    pop                     r14
+    pop                     r13
+    pop                     r12
+    pop                     r11
+    pop                     rdi
+    pop                     rsi
+    pop                     rbx
+
+    ret
+parutilMemoryGather64Thread                 ENDP
+
+; ---------
+
+parutilMemoryScatter32Thread                PROC PUBLIC
+    ; Save non-volatile registers.
+    push                    rbx
+    push                    rsi
+    push                    rdi
+    push                    r11
+    push                    r12
+    push                    r13
+    push                    r14
+    
+    ; Set aside the original parameters.
+    mov                     r11,                    r64_param1
+    mov                     r12,                    r64_param2
+    mov                     r14,                    r64_param3
+    mov                     r13,                    r64_param4
+    
+    ; Initialize.
+    parutilSchedulerInitStaticChunk
+    
+    ; Perform the scatter operation assigned to this thread.
+  parutilMemoryScatter32ThreadLoop:
+    cmp                     rsi,                    rdi
+    jge                     parutilMemoryScatter32ThreadDone
+    
+    ; Prefetch the destination elements to be written a few blocks ahead, provided those blocks are also assigned to this thread.
+    lea                     rax,                    [rsi+kParutilMemoryIndexedPrefetchDistance]
+    cmp                     rax,                    rdi
+    jge                     parutilMemoryScatter32ThreadScatter
+    shl                     rax,                    6
+    add                     rax,                    r14
+    parutilMemoryPrefetchIndexed32              r11,                    rax
+    
+  parutilMemoryScatter32ThreadScatter:
+    ; Compute the addresses of the 64-byte blocks of source elements and indices.
+    ; This is equal to the iteration index multiplied by 64, or left-shifted by 6.
+    mov                     rcx,                    rsi
+    shl                     rcx,                    6
+    lea                     r8,                     [r14+rcx]
+    lea                     r9,                     [r12+rcx]
+    
+    ; Perform the scatter operation, one element at a time.
+    xor                     rcx,                    rcx
+  parutilMemoryScatter32ThreadElementLoop:
+    mov                     eax,                    DWORD PTR [r8+rcx*4]
+    mov                     edx,                    DWORD PTR [r9+rcx*4]
+    mov                     DWORD PTR [r11+rax*4],  edx
+    add                     rcx,                    1
+    cmp                     rcx,                    16
+    jl                      parutilMemoryScatter32ThreadElementLoop
+    
+    add                     rsi,                    1
+    jmp                     parutilMemoryScatter32ThreadLoop
+  parutilMemoryScatter32ThreadDone:
+    
+    ; Restore non-volatile registers and return.
+    pop                     r14
+    pop                     r13
+    pop                     r12
+    pop                     r11
+    pop                     rdi
+    pop                     rsi
+    pop                     rbx
+
+    ret
+parutilMemoryScatter32Thread                ENDP
+
+; ---------
+
+parutilMemoryScatter64Thread                PROC PUBLIC
+    ; Save non-volatile registers.
+    push                    rbx
+    push                    rsi
+    push                    rdi
+    push                    r11
+    push                    r12
+    push                    r13
+    push                    r14
+    
+    ; Set aside the original parameters.
+    mov                     r11,                    r64_param1
+    mov                     r12,                    r64_param2
+    mov                     r14,                    r64_param3
+    mov                     r13,                    r64_param4
+    
+    ; Initialize.
+    parutilSchedulerInitStaticChunk
+    
+    ; Perform the scatter operation assigned to this thread.
+  parutilMemoryScatter64ThreadLoop:
+    cmp                     rsi,                    rdi
+    jge                     parutilMemoryScatter64ThreadDone
+    
+    ; Prefetch the destination elements to be written a few blocks ahead, provided those blocks are also assigned to this thread.
+    lea                     rax,                    [rsi+kParutilMemoryIndexedPrefetchDistance]
+    cmp                     rax,                    rdi
+    jge                     parutilMemoryScatter64ThreadScatter
+    shl                     rax,                    6
+    add                     rax,                    r14
+    parutilMemoryPrefetchIndexed64              r11,                    rax
+    
+  parutilMemoryScatter64ThreadScatter:
+    ; Compute the addresses of the 64-byte blocks of source elements and indices.
+    ; This is equal to the iteration index multiplied by 64, or left-shifted by 6.
+    mov                     rcx,                    rsi
+    shl                     rcx,                    6
+    lea                     r8,                     [r14+rcx]
+    lea                     r9,                     [r12+rcx]
+    
+    ; Perform the scatter operation, one element at a time.
+    xor                     rcx,                    rcx
+  parutilMemoryScatter64ThreadElementLoop:
+    mov                     rax,                    QWORD PTR [r8+rcx*8]
+    mov                     rdx,                    QWORD PTR [r9+rcx*8]
+    mov                     QWORD PTR [r11+rax*8],  rdx
+    add                     rcx,                    1
+    cmp                     rcx,                    8
+    jl                      parutilMemoryScatter64ThreadElementLoop
+    
+    add                     rsi,                    1
+    jmp                     parutilMemoryScatter64ThreadLoop
+  parutilMemoryScatter64ThreadDone:
+    
+    ; Restore non-volatile registers and return.
+    pop                     r14
+    pop                     r13
+    pop                     r12
+    pop                     r11
+    pop                     rdi
+    pop                     rsi
+    pop                     rbx
+
+    ret
+parutilMemoryScatter64Thread                ENDP
+
+; ---------
+
 parutilMemorySetAlignedThread               PROC PUBLIC
     ; Save non-volatile registers.
     push                    rbx
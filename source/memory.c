@@ -11,9 +11,12 @@
  *****************************************************************************/
 
 #include "memory.h"
+#include "stats.h"
 
+#include <nmmintrin.h>
 #include <silo.h>
 #include <spindle.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 
@@ -22,6 +25,12 @@
 /// Minimum size of a memory operation, in bytes, before Parutil will parallelize it.
 static const size_t kParutilMinimumOperationSize = 4ull * 1024ull;
 
+/// CRC32C (Castagnoli) polynomial, in the bit-reflected form used by the `crc32` instruction.
+static const uint32_t kParutilMemoryChecksumPolynomial = 0x82f63b78;
+
+/// Initial CRC32C state, which is also complemented into the final value.
+static const uint32_t kParutilMemoryChecksumInitialState = 0xffffffff;
+
 
 // -------- TYPE DEFINITIONS ----------------------------------------------- //
 
@@ -31,13 +40,161 @@ typedef struct SParutilMemoryOperationSpec
 {
     void* destination;                                                      ///< Base address of the destination memory buffer.
     const void* source;                                                     ///< Base address of the source memory buffer. Not all memory operations need this information.
-    uint64_t value;                                                         ///< Arbitrary value argument to be used by individual memory operations. Not all memory operations need this information.
+    const void* indices;                                                    ///< Base address of the index array used by indexed memory operations. Not all memory operations need this information.
+    uint64_t value;                                                         ///< Arbitrary value argument to be used by individual memory operations. Not all memory operations need this information. Checksum operations use it for the checksum state, both as input and as output.
     size_t num64;                                                           ///< Number of 64-byte blocks (cache lines) to include in the memory operation.
 } SParutilMemoryOperationSpec;
 
 
 // -------- INTERNAL FUNCTIONS --------------------------------------------- //
 
+/// Multiplies two polynomials modulo the CRC32C polynomial.
+/// Operands and result use the same bit-reflected representation as CRC32C values, in which the most-significant bit holds the coefficient of x^0.
+/// @param [in] a First operand.
+/// @param [in] b Second operand.
+/// @return Product of the two operands.
+static uint32_t parutilMemoryChecksumMultiply(uint32_t a, uint32_t b)
+{
+    uint32_t product = 0;
+
+    for (uint32_t i = 0; i < 32; ++i)
+    {
+        if (a & (0x80000000 >> i))
+            product ^= b;
+
+        b = (b & 1) ? ((b >> 1) ^ kParutilMemoryChecksumPolynomial) : (b >> 1);
+    }
+
+    return product;
+}
+
+/// Computes the operator that advances a CRC32C state as if `num` zero-valued bytes were processed, without actually processing them.
+/// Applying the operator is a single #parutilMemoryChecksumMultiply with the state to advance.
+/// This is what allows checksums of consecutive chunks to be computed independently and then combined.
+/// The state after processing chunks A and B is the state after A advanced by the length of B, exclusive-or the checksum of B computed starting from zero.
+/// @param [in] num Number of bytes by which to advance.
+/// @return Operator x^(8 * num), in the same representation as CRC32C values.
+static uint32_t parutilMemoryChecksumShiftOperator(size_t num)
+{
+    // Compute x^(8 * num) by repeated squaring, starting with x^8 for a single byte and x^0 for the result.
+    uint32_t power = 0x00800000;
+    uint32_t shift = 0x80000000;
+
+    while (0 != num)
+    {
+        if (num & 1)
+            shift = parutilMemoryChecksumMultiply(power, shift);
+
+        power = parutilMemoryChecksumMultiply(power, power);
+        num >>= 1;
+    }
+
+    return shift;
+}
+
+/// Updates a CRC32C state by processing `num` bytes of memory at `buffer` on the calling thread.
+/// @param [in] checksumState CRC32C state to update.
+/// @param [in] buffer Source memory buffer.
+/// @param [in] num Number of bytes to process.
+/// @return Updated CRC32C state.
+static uint32_t parutilMemoryChecksumUpdate(uint32_t checksumState, const uint8_t* buffer, size_t num)
+{
+    size_t i = 0;
+
+    for (; (i + 8) <= num; i += 8)
+        checksumState = (uint32_t)_mm_crc32_u64((uint64_t)checksumState, *((const uint64_t*)&buffer[i]));
+
+    for (; i < num; ++i)
+        checksumState = _mm_crc32_u8(checksumState, buffer[i]);
+
+    return checksumState;
+}
+
+/// Parallelized part of checksum operations, optionally combined with a memory copy.
+/// Intended to be called from within the context of a Spindle parallelized region, by all threads in the task.
+/// Each thread checksums its own chunk, and then every thread combines the per-chunk checksums in chunk order.
+/// @param [in] memoryOpSpec Information about the overall operation. A `NULL` destination indicates that no copy is to be performed.
+/// @param [in,out] checksumState CRC32C state before the memory covered by the operation, updated to the state after it.
+/// @return `true` if successful, `false` if memory could not be allocated.
+static bool parutilMemoryChecksumParallel(SParutilMemoryOperationSpec* memoryOpSpec, uint32_t* checksumState)
+{
+    const uint32_t threadID = spindleGetLocalThreadID();
+    const uint32_t threadCount = spindleGetLocalThreadCount();
+    uint32_t* chunkChecksums = NULL;
+    uint64_t numUnits = (uint64_t)memoryOpSpec->num64;
+    size_t unitSize = 64;
+    uint32_t combinedChecksumState = *checksumState;
+
+    if (0 == threadID)
+    {
+        // First thread allocates and shares the array that holds the checksum of each chunk.
+        chunkChecksums = (uint32_t*)siloSimpleBufferAllocLocal(sizeof(uint32_t) * threadCount);
+        spindleDataShareSendLocal((uint64_t)chunkChecksums);
+    }
+    else
+    {
+        // All other threads wait for the address of the array.
+        chunkChecksums = (uint32_t*)spindleDataShareReceiveLocal();
+    }
+
+    if (NULL == chunkChecksums)
+        return false;
+
+    if (NULL == memoryOpSpec->destination)
+    {
+        chunkChecksums[threadID] = parutilMemoryChecksumThread(memoryOpSpec->source, memoryOpSpec->num64);
+    }
+    else if (((size_t)memoryOpSpec->destination & (size_t)31) || ((size_t)memoryOpSpec->source & (size_t)31))
+    {
+        // Either the source or destination address is not aligned on a 256-bit (32-byte) boundary, so the unaligned copy implementation must be used.
+        // It schedules work in 8-byte units rather than 64-byte blocks, which changes the size of each chunk.
+        chunkChecksums[threadID] = parutilMemoryCopyChecksumUnalignedThread(memoryOpSpec->destination, memoryOpSpec->source, memoryOpSpec->num64);
+        numUnits <<= 3ull;
+        unitSize = 8;
+    }
+    else
+    {
+        chunkChecksums[threadID] = parutilMemoryCopyChecksumAlignedThread(memoryOpSpec->destination, memoryOpSpec->source, memoryOpSpec->num64);
+    }
+
+    spindleBarrierLocal();
+
+    // Combine the checksums in chunk order.
+    // Chunk sizes match the static chunked scheduler, which gives each thread an equal share and distributes the remainder to the threads with the lowest identifiers.
+    // There are therefore only two distinct chunk sizes, so only two shift operators are needed.
+    {
+        const uint64_t numUnitsInSmallChunk = numUnits / threadCount;
+        const uint64_t numLargeChunks = numUnits % threadCount;
+        const uint32_t smallChunkShift = parutilMemoryChecksumShiftOperator((size_t)numUnitsInSmallChunk * unitSize);
+        const uint32_t largeChunkShift = ((0 != numLargeChunks) ? parutilMemoryChecksumShiftOperator((size_t)(numUnitsInSmallChunk + 1) * unitSize) : smallChunkShift);
+
+        for (uint32_t t = 0; t < threadCount; ++t)
+            combinedChecksumState = parutilMemoryChecksumMultiply(((t < numLargeChunks) ? largeChunkShift : smallChunkShift), combinedChecksumState) ^ chunkChecksums[t];
+    }
+
+    // First thread frees the array once all threads are finished with it.
+    spindleBarrierLocal();
+
+    if (0 == threadID)
+        siloFree(chunkChecksums);
+
+    *checksumState = combinedChecksumState;
+    return true;
+}
+
+/// Internal control function for checksum operations, optionally combined with a memory copy.
+/// @param [in] arg Pointer to the #SParutilMemoryOperationSpec structure that contains information about the overall checksum operation to be parallelized.
+static void parutilMemoryChecksumInternalThread(void* arg)
+{
+    SParutilMemoryOperationSpec* memoryOpSpec = (SParutilMemoryOperationSpec*)arg;
+    uint32_t checksumState = (uint32_t)memoryOpSpec->value;
+    const bool result = parutilMemoryChecksumParallel(memoryOpSpec, &checksumState);
+
+    // First thread reports the result, using an out-of-range value to indicate failure.
+    if (0 == spindleGetLocalThreadID())
+        memoryOpSpec->value = (result ? (uint64_t)checksumState : UINT64_MAX);
+}
+
 /// Internal control function for memory copy operations.
 /// @param [in] arg Pointer to the #SParutilMemoryOperationSpec structure that contains information about the overall memory copy operation to be parallelized.
 static void parutilMemoryCopyInternalThread(void* arg)
@@ -67,6 +224,42 @@ static void parutilMemoryFilterInternalThread(void* arg)
     parutilMemoryFilterAlignedThread(memoryOpSpec->destination, memoryOpSpec->value, memoryOpSpec->num64);
 }
 
+/// Internal control function for 32-bit gather operations.
+/// @param [in] arg Pointer to the #SParutilMemoryOperationSpec structure that contains information about the overall gather operation to be parallelized.
+static void parutilMemoryGather32InternalThread(void* arg)
+{
+    SParutilMemoryOperationSpec* memoryOpSpec = (SParutilMemoryOperationSpec*)arg;
+    
+    parutilMemoryGather32Thread((uint32_t*)memoryOpSpec->destination, (const uint32_t*)memoryOpSpec->source, (const uint32_t*)memoryOpSpec->indices, memoryOpSpec->num64);
+}
+
+/// Internal control function for 64-bit gather operations.
+/// @param [in] arg Pointer to the #SParutilMemoryOperationSpec structure that contains information about the overall gather operation to be parallelized.
+static void parutilMemoryGather64InternalThread(void* arg)
+{
+    SParutilMemoryOperationSpec* memoryOpSpec = (SParutilMemoryOperationSpec*)arg;
+    
+    parutilMemoryGather64Thread((uint64_t*)memoryOpSpec->destination, (const uint64_t*)memoryOpSpec->source, (const uint64_t*)memoryOpSpec->indices, memoryOpSpec->num64);
+}
+
+/// Internal control function for 32-bit scatter operations.
+/// @param [in] arg Pointer to the #SParutilMemoryOperationSpec structure that contains information about the overall scatter operation to be parallelized.
+static void parutilMemoryScatter32InternalThread(void* arg)
+{
+    SParutilMemoryOperationSpec* memoryOpSpec = (SParutilMemoryOperationSpec*)arg;
+    
+    parutilMemoryScatter32Thread((uint32_t*)memoryOpSpec->destination, (const uint32_t*)memoryOpSpec->source, (const uint32_t*)memoryOpSpec->indices, memoryOpSpec->num64);
+}
+
+/// Internal control function for 64-bit scatter operations.
+/// @param [in] arg Pointer to the #SParutilMemoryOperationSpec structure that contains information about the overall scatter operation to be parallelized.
+static void parutilMemoryScatter64InternalThread(void* arg)
+{
+    SParutilMemoryOperationSpec* memoryOpSpec = (SParutilMemoryOperationSpec*)arg;
+    
+    parutilMemoryScatter64Thread((uint64_t*)memoryOpSpec->destination, (const uint64_t*)memoryOpSpec->source, (const uint64_t*)memoryOpSpec->indices, memoryOpSpec->num64);
+}
+
 /// Internal control function for memory initialization operations.
 /// @param [in] arg Pointer to the #SParutilMemoryOperationSpec structure that contains information about the overall memory initialization operation to be parallelized.
 static void parutilMemorySetInternalThread(void* arg)
@@ -81,8 +274,78 @@ static void parutilMemorySetInternalThread(void* arg)
 // -------- FUNCTIONS ------------------------------------------------------ //
 // See "parutil.h" for documentation.
 
+bool parutilMemoryChecksum(const void* buffer, size_t num, uint32_t* const checksum)
+{
+    const uint64_t statsStartTimestamp = parutilStatsTimestamp();
+    uint32_t checksumState = kParutilMemoryChecksumInitialState;
+    
+    if (NULL == checksum)
+        return false;
+    
+    if (num < (kParutilMinimumOperationSize))
+    {
+        // For small enough buffers, it is not worth the overhead of setting up threads to parallelize.
+        // Every thread computes the checksum itself, since doing so does not modify the buffer.
+        checksumState = parutilMemoryChecksumUpdate(checksumState, (const uint8_t*)buffer, num);
+    }
+    else
+    {
+        SParutilMemoryOperationSpec memoryOpSpec;
+        
+        // Ensure the actual parallelized implementation is invoked with a multiple of 64 blocks.
+        // The underlying checksum implementation has no alignment requirements, so only the tail end needs correction, which is done after the parallelized part.
+        const size_t numUnalignedBytes = (num & 63);
+        
+        // Set up control information for the checksum operation.
+        memoryOpSpec.destination = NULL;
+        memoryOpSpec.source = buffer;
+        memoryOpSpec.indices = NULL;
+        memoryOpSpec.value = (uint64_t)checksumState;
+        memoryOpSpec.num64 = num >> 6;
+        
+        if (spindleIsInParallelRegion())
+        {
+            if (!parutilMemoryChecksumParallel(&memoryOpSpec, &checksumState))
+                return false;
+        }
+        else
+        {
+            SSpindleTaskSpec taskSpec;
+            int32_t targetNUMANode = siloGetNUMANodeForVirtualAddress((void*)buffer);
+            
+            // Set up control information for Spindle.
+            if (0 > targetNUMANode)
+                targetNUMANode = 0;
+            
+            taskSpec.func = &parutilMemoryChecksumInternalThread;
+            taskSpec.arg = (void*)&memoryOpSpec;
+            taskSpec.numaNode = targetNUMANode;
+            taskSpec.numThreads = 0;
+            taskSpec.smtPolicy = SpindleSMTPolicyPreferPhysical;
+            
+            // Dispatch the checksum operation.
+            if ((0 != parutilStatsThreadsSpawn(&taskSpec, ParutilStatsOperationMemoryChecksum)) || (UINT64_MAX == memoryOpSpec.value))
+                return false;
+            
+            checksumState = (uint32_t)memoryOpSpec.value;
+        }
+        
+        checksumState = parutilMemoryChecksumUpdate(checksumState, &((const uint8_t*)buffer)[num - numUnalignedBytes], numUnalignedBytes);
+    }
+    
+    *checksum = ~checksumState;
+    
+    parutilStatsRecordOperation(ParutilStatsOperationMemoryChecksum, num, statsStartTimestamp, (num < (kParutilMinimumOperationSize)), false);
+    return true;
+}
+
+// --------
+
 void* parutilMemoryCopy(void* destination, const void* source, size_t num)
 {
+    const uint64_t statsStartTimestamp = parutilStatsTimestamp();
+    const size_t statsNumBytes = num;
+    
     if (num < (kParutilMinimumOperationSize))
     {
         // For small enough buffers, it is not worth the overhead of setting up threads to parallelize.
@@ -92,6 +355,7 @@ void* parutilMemoryCopy(void* destination, const void* source, size_t num)
                 ((uint8_t*)destination)[i] = ((uint8_t*)source)[i];
         }
         
+        parutilStatsRecordOperation(ParutilStatsOperationMemoryCopy, statsNumBytes, statsStartTimestamp, true, false);
         return destination;
     }
     else
@@ -130,6 +394,7 @@ void* parutilMemoryCopy(void* destination, const void* source, size_t num)
         // Set up control information for the memory copy operation.
         memoryOpSpec.destination = destination;
         memoryOpSpec.source = source;
+        memoryOpSpec.indices = NULL;
         memoryOpSpec.value = 0ull;
         memoryOpSpec.num64 = num >> 6;
         
@@ -154,18 +419,119 @@ void* parutilMemoryCopy(void* destination, const void* source, size_t num)
             taskSpec.smtPolicy = SpindleSMTPolicyPreferPhysical;
             
             // Dispatch the memory copy operation.
-            if (0 != spindleThreadsSpawn(&taskSpec, 1, false))
+            if (0 != parutilStatsThreadsSpawn(&taskSpec, ParutilStatsOperationMemoryCopy))
                 return NULL;
         }
         
+        parutilStatsRecordOperation(ParutilStatsOperationMemoryCopy, statsNumBytes, statsStartTimestamp, false, ((((size_t)destination) & 31) || (((size_t)source) & 31)));
         return destination;
     }
 }
 
 // --------
 
+void* parutilMemoryCopyChecksum(void* destination, const void* source, size_t num, uint32_t* const checksum)
+{
+    const uint64_t statsStartTimestamp = parutilStatsTimestamp();
+    bool statsIsUnaligned = false;
+    uint32_t checksumState = kParutilMemoryChecksumInitialState;
+    
+    if (NULL == checksum)
+        return NULL;
+    
+    if (num < (kParutilMinimumOperationSize))
+    {
+        // For small enough buffers, it is not worth the overhead of setting up threads to parallelize.
+        // Every thread computes the checksum itself, since doing so only reads the source buffer.
+        if ((!spindleIsInParallelRegion()) || (0 == spindleGetLocalThreadID()))
+        {
+            for (size_t i = 0; i < num; ++i)
+                ((uint8_t*)destination)[i] = ((uint8_t*)source)[i];
+        }
+        
+        checksumState = parutilMemoryChecksumUpdate(checksumState, (const uint8_t*)source, num);
+    }
+    else
+    {
+        SParutilMemoryOperationSpec memoryOpSpec;
+        size_t numUnalignedBytes = 0;
+        
+        // Try to steer the implementation towards 64-byte alignment, as is done for memory copy operations.
+        // If source and destination pointers have similar cache-line alignment and are both off-alignment, correct for that here.
+        if ((((size_t)destination) & 63) == (((size_t)source) & 63))
+            numUnalignedBytes = (64 - (((size_t)destination) & 63)) & 63;
+        
+        if ((!spindleIsInParallelRegion()) || (0 == spindleGetLocalThreadID()))
+        {
+            for (size_t i = 0; i < numUnalignedBytes; ++i)
+                ((uint8_t*)destination)[i] = ((uint8_t*)source)[i];
+        }
+        
+        checksumState = parutilMemoryChecksumUpdate(checksumState, (const uint8_t*)source, numUnalignedBytes);
+        
+        // Set up control information for the copy-and-checksum operation.
+        // Any tail-end correction needed to invoke the parallelized implementation with a multiple of 64 blocks is done afterwards, since the checksum must be computed in order.
+        memoryOpSpec.destination = (void*)((size_t)destination + numUnalignedBytes);
+        memoryOpSpec.source = (const void*)((size_t)source + numUnalignedBytes);
+        memoryOpSpec.indices = NULL;
+        memoryOpSpec.value = (uint64_t)checksumState;
+        memoryOpSpec.num64 = (num - numUnalignedBytes) >> 6;
+        
+        statsIsUnaligned = ((((size_t)memoryOpSpec.destination) & 31) || (((size_t)memoryOpSpec.source) & 31));
+        
+        if (spindleIsInParallelRegion())
+        {
+            spindleBarrierLocal();
+            
+            if (!parutilMemoryChecksumParallel(&memoryOpSpec, &checksumState))
+                return NULL;
+        }
+        else
+        {
+            SSpindleTaskSpec taskSpec;
+            int32_t targetNUMANode = siloGetNUMANodeForVirtualAddress(destination);
+            
+            // Set up control information for Spindle.
+            if (0 > targetNUMANode)
+                targetNUMANode = 0;
+            
+            taskSpec.func = &parutilMemoryChecksumInternalThread;
+            taskSpec.arg = (void*)&memoryOpSpec;
+            taskSpec.numaNode = targetNUMANode;
+            taskSpec.numThreads = 0;
+            taskSpec.smtPolicy = SpindleSMTPolicyPreferPhysical;
+            
+            // Dispatch the copy-and-checksum operation.
+            if ((0 != parutilStatsThreadsSpawn(&taskSpec, ParutilStatsOperationMemoryCopyChecksum)) || (UINT64_MAX == memoryOpSpec.value))
+                return NULL;
+            
+            checksumState = (uint32_t)memoryOpSpec.value;
+        }
+        
+        numUnalignedBytes = (num - numUnalignedBytes) & 63;
+        
+        if ((!spindleIsInParallelRegion()) || (0 == spindleGetLocalThreadID()))
+        {
+            for (size_t i = 0; i < numUnalignedBytes; ++i)
+                ((uint8_t*)destination)[num - i - 1] = ((uint8_t*)source)[num - i - 1];
+        }
+        
+        checksumState = parutilMemoryChecksumUpdate(checksumState, &((const uint8_t*)source)[num - numUnalignedBytes], numUnalignedBytes);
+    }
+    
+    *checksum = ~checksumState;
+    
+    parutilStatsRecordOperation(ParutilStatsOperationMemoryCopyChecksum, num, statsStartTimestamp, (num < (kParutilMinimumOperationSize)), statsIsUnaligned);
+    return destination;
+}
+
+// --------
+
 void* parutilMemoryFilter(void* buffer, uint8_t value, size_t num)
 {
+    const uint64_t statsStartTimestamp = parutilStatsTimestamp();
+    const size_t statsNumBytes = num;
+    
     if (num < (kParutilMinimumOperationSize))
     {
         // For small enough buffers, it is not worth the overhead of setting up threads to parallelize.
@@ -175,6 +541,7 @@ void* parutilMemoryFilter(void* buffer, uint8_t value, size_t num)
                 ((uint8_t*)buffer)[i] &= value;
         }
         
+        parutilStatsRecordOperation(ParutilStatsOperationMemoryFilter, statsNumBytes, statsStartTimestamp, true, false);
         return buffer;
     }
     else
@@ -212,6 +579,7 @@ void* parutilMemoryFilter(void* buffer, uint8_t value, size_t num)
         // Set up control information for the memory set operation.
         memoryOpSpec.destination = buffer;
         memoryOpSpec.source = NULL;
+        memoryOpSpec.indices = NULL;
         memoryOpSpec.value = (uint64_t)value;
         memoryOpSpec.value |= memoryOpSpec.value << 32ull;
         memoryOpSpec.value |= memoryOpSpec.value << 16ull;
@@ -239,18 +607,322 @@ void* parutilMemoryFilter(void* buffer, uint8_t value, size_t num)
             taskSpec.smtPolicy = SpindleSMTPolicyPreferPhysical;
             
             // Dispatch the memory set operation.
-            if (0 != spindleThreadsSpawn(&taskSpec, 1, false))
+            if (0 != parutilStatsThreadsSpawn(&taskSpec, ParutilStatsOperationMemoryFilter))
                 return NULL;
         }
 
+        parutilStatsRecordOperation(ParutilStatsOperationMemoryFilter, statsNumBytes, statsStartTimestamp, false, false);
         return buffer;
     }
 }
 
 // --------
 
+uint32_t* parutilMemoryGather32(uint32_t* destination, const uint32_t* source, const uint32_t* indices, size_t num)
+{
+    const uint64_t statsStartTimestamp = parutilStatsTimestamp();
+    const size_t statsNumBytes = num * sizeof(uint32_t);
+    
+    if ((num * sizeof(uint32_t)) < (kParutilMinimumOperationSize))
+    {
+        // For small enough buffers, it is not worth the overhead of setting up threads to parallelize.
+        if ((!spindleIsInParallelRegion()) || (0 == spindleGetLocalThreadID()))
+        {
+            for (size_t i = 0; i < num; ++i)
+                destination[i] = source[indices[i]];
+        }
+        
+        parutilStatsRecordOperation(ParutilStatsOperationMemoryGather32, statsNumBytes, statsStartTimestamp, true, false);
+        return destination;
+    }
+    else
+    {
+        SParutilMemoryOperationSpec memoryOpSpec;
+        size_t numUnalignedElements;
+        
+        // Steer the implementation towards 64-byte alignment of the destination.
+        // The underlying gather implementation writes the destination using 256-bit (32-byte) AVX non-temporal stores in groups of 2, for an effective block size of 512 bits (64 bytes).
+        // Correct for destination mis-alignment here, one element at a time.
+        numUnalignedElements = ((64 - (((size_t)destination) & 63)) & 63) / sizeof(uint32_t);
+        
+        if ((!spindleIsInParallelRegion()) || (0 == spindleGetLocalThreadID()))
+        {
+            for (size_t i = 0; i < numUnalignedElements; ++i)
+                destination[i] = source[indices[i]];
+        }
+        
+        num -= numUnalignedElements;
+        
+        // Ensure the actual parallelized implementation is invoked with a multiple of 64 bytes, and perform any needed tail-end correction here.
+        // Corrections are done at the tail end to ensure preservation of array base address alignment.
+        if ((!spindleIsInParallelRegion()) || (0 == spindleGetLocalThreadID()))
+        {
+            for (size_t i = numUnalignedElements + (num & ~((size_t)15)); i < numUnalignedElements + num; ++i)
+                destination[i] = source[indices[i]];
+        }
+        
+        // Set up control information for the gather operation.
+        memoryOpSpec.destination = (void*)&destination[numUnalignedElements];
+        memoryOpSpec.source = (const void*)source;
+        memoryOpSpec.indices = (const void*)&indices[numUnalignedElements];
+        memoryOpSpec.value = 0ull;
+        memoryOpSpec.num64 = num >> 4;
+        
+        if (spindleIsInParallelRegion())
+        {
+            spindleBarrierLocal();
+            parutilMemoryGather32InternalThread((void*)&memoryOpSpec);
+        }
+        else
+        {
+            SSpindleTaskSpec taskSpec;
+            int32_t targetNUMANode = siloGetNUMANodeForVirtualAddress(destination);
+            
+            // Set up control information for Spindle.
+            if (0 > targetNUMANode)
+                targetNUMANode = 0;
+            
+            taskSpec.func = &parutilMemoryGather32InternalThread;
+            taskSpec.arg = (void*)&memoryOpSpec;
+            taskSpec.numaNode = targetNUMANode;
+            taskSpec.numThreads = 0;
+            taskSpec.smtPolicy = SpindleSMTPolicyPreferPhysical;
+            
+            // Dispatch the gather operation.
+            if (0 != parutilStatsThreadsSpawn(&taskSpec, ParutilStatsOperationMemoryGather32))
+                return NULL;
+        }
+        
+        parutilStatsRecordOperation(ParutilStatsOperationMemoryGather32, statsNumBytes, statsStartTimestamp, false, false);
+        return destination;
+    }
+}
+
+// --------
+
+uint64_t* parutilMemoryGather64(uint64_t* destination, const uint64_t* source, const uint64_t* indices, size_t num)
+{
+    const uint64_t statsStartTimestamp = parutilStatsTimestamp();
+    const size_t statsNumBytes = num * sizeof(uint64_t);
+    
+    if ((num * sizeof(uint64_t)) < (kParutilMinimumOperationSize))
+    {
+        // For small enough buffers, it is not worth the overhead of setting up threads to parallelize.
+        if ((!spindleIsInParallelRegion()) || (0 == spindleGetLocalThreadID()))
+        {
+            for (size_t i = 0; i < num; ++i)
+                destination[i] = source[indices[i]];
+        }
+        
+        parutilStatsRecordOperation(ParutilStatsOperationMemoryGather64, statsNumBytes, statsStartTimestamp, true, false);
+        return destination;
+    }
+    else
+    {
+        SParutilMemoryOperationSpec memoryOpSpec;
+        size_t numUnalignedElements;
+        
+        // Steer the implementation towards 64-byte alignment of the destination.
+        // The underlying gather implementation writes the destination using 256-bit (32-byte) AVX non-temporal stores in groups of 2, for an effective block size of 512 bits (64 bytes).
+        // Correct for destination mis-alignment here, one element at a time.
+        numUnalignedElements = ((64 - (((size_t)destination) & 63)) & 63) / sizeof(uint64_t);
+        
+        if ((!spindleIsInParallelRegion()) || (0 == spindleGetLocalThreadID()))
+        {
+            for (size_t i = 0; i < numUnalignedElements; ++i)
+                destination[i] = source[indices[i]];
+        }
+        
+        num -= numUnalignedElements;
+        
+        // Ensure the actual parallelized implementation is invoked with a multiple of 64 bytes, and perform any needed tail-end correction here.
+        // Corrections are done at the tail end to ensure preservation of array base address alignment.
+        if ((!spindleIsInParallelRegion()) || (0 == spindleGetLocalThreadID()))
+        {
+            for (size_t i = numUnalignedElements + (num & ~((size_t)7)); i < numUnalignedElements + num; ++i)
+                destination[i] = source[indices[i]];
+        }
+        
+        // Set up control information for the gather operation.
+        memoryOpSpec.destination = (void*)&destination[numUnalignedElements];
+        memoryOpSpec.source = (const void*)source;
+        memoryOpSpec.indices = (const void*)&indices[numUnalignedElements];
+        memoryOpSpec.value = 0ull;
+        memoryOpSpec.num64 = num >> 3;
+        
+        if (spindleIsInParallelRegion())
+        {
+            spindleBarrierLocal();
+            parutilMemoryGather64InternalThread((void*)&memoryOpSpec);
+        }
+        else
+        {
+            SSpindleTaskSpec taskSpec;
+            int32_t targetNUMANode = siloGetNUMANodeForVirtualAddress(destination);
+            
+            // Set up control information for Spindle.
+            if (0 > targetNUMANode)
+                targetNUMANode = 0;
+            
+            taskSpec.func = &parutilMemoryGather64InternalThread;
+            taskSpec.arg = (void*)&memoryOpSpec;
+            taskSpec.numaNode = targetNUMANode;
+            taskSpec.numThreads = 0;
+            taskSpec.smtPolicy = SpindleSMTPolicyPreferPhysical;
+            
+            // Dispatch the gather operation.
+            if (0 != parutilStatsThreadsSpawn(&taskSpec, ParutilStatsOperationMemoryGather64))
+                return NULL;
+        }
+        
+        parutilStatsRecordOperation(ParutilStatsOperationMemoryGather64, statsNumBytes, statsStartTimestamp, false, false);
+        return destination;
+    }
+}
+
+// --------
+
+uint32_t* parutilMemoryScatter32(uint32_t* destination, const uint32_t* source, const uint32_t* indices, size_t num)
+{
+    const uint64_t statsStartTimestamp = parutilStatsTimestamp();
+    const size_t statsNumBytes = num * sizeof(uint32_t);
+    
+    if ((num * sizeof(uint32_t)) < (kParutilMinimumOperationSize))
+    {
+        // For small enough buffers, it is not worth the overhead of setting up threads to parallelize.
+        if ((!spindleIsInParallelRegion()) || (0 == spindleGetLocalThreadID()))
+        {
+            for (size_t i = 0; i < num; ++i)
+                destination[indices[i]] = source[i];
+        }
+        
+        parutilStatsRecordOperation(ParutilStatsOperationMemoryScatter32, statsNumBytes, statsStartTimestamp, true, false);
+        return destination;
+    }
+    else
+    {
+        SParutilMemoryOperationSpec memoryOpSpec;
+        
+        // Ensure the actual parallelized implementation is invoked with a multiple of 64 bytes, and perform any needed tail-end correction here.
+        // The destination is accessed randomly, so there is no alignment to preserve.
+        if ((!spindleIsInParallelRegion()) || (0 == spindleGetLocalThreadID()))
+        {
+            for (size_t i = (num & ~((size_t)15)); i < num; ++i)
+                destination[indices[i]] = source[i];
+        }
+        
+        // Set up control information for the scatter operation.
+        memoryOpSpec.destination = (void*)destination;
+        memoryOpSpec.source = (const void*)source;
+        memoryOpSpec.indices = (const void*)indices;
+        memoryOpSpec.value = 0ull;
+        memoryOpSpec.num64 = num >> 4;
+        
+        if (spindleIsInParallelRegion())
+        {
+            spindleBarrierLocal();
+            parutilMemoryScatter32InternalThread((void*)&memoryOpSpec);
+        }
+        else
+        {
+            SSpindleTaskSpec taskSpec;
+            int32_t targetNUMANode = siloGetNUMANodeForVirtualAddress(destination);
+            
+            // Set up control information for Spindle.
+            if (0 > targetNUMANode)
+                targetNUMANode = 0;
+            
+            taskSpec.func = &parutilMemoryScatter32InternalThread;
+            taskSpec.arg = (void*)&memoryOpSpec;
+            taskSpec.numaNode = targetNUMANode;
+            taskSpec.numThreads = 0;
+            taskSpec.smtPolicy = SpindleSMTPolicyPreferPhysical;
+            
+            // Dispatch the scatter operation.
+            if (0 != parutilStatsThreadsSpawn(&taskSpec, ParutilStatsOperationMemoryScatter32))
+                return NULL;
+        }
+        
+        parutilStatsRecordOperation(ParutilStatsOperationMemoryScatter32, statsNumBytes, statsStartTimestamp, false, false);
+        return destination;
+    }
+}
+
+// --------
+
+uint64_t* parutilMemoryScatter64(uint64_t* destination, const uint64_t* source, const uint64_t* indices, size_t num)
+{
+    const uint64_t statsStartTimestamp = parutilStatsTimestamp();
+    const size_t statsNumBytes = num * sizeof(uint64_t);
+    
+    if ((num * sizeof(uint64_t)) < (kParutilMinimumOperationSize))
+    {
+        // For small enough buffers, it is not worth the overhead of setting up threads to parallelize.
+        if ((!spindleIsInParallelRegion()) || (0 == spindleGetLocalThreadID()))
+        {
+            for (size_t i = 0; i < num; ++i)
+                destination[indices[i]] = source[i];
+        }
+        
+        parutilStatsRecordOperation(ParutilStatsOperationMemoryScatter64, statsNumBytes, statsStartTimestamp, true, false);
+        return destination;
+    }
+    else
+    {
+        SParutilMemoryOperationSpec memoryOpSpec;
+        
+        // Ensure the actual parallelized implementation is invoked with a multiple of 64 bytes, and perform any needed tail-end correction here.
+        // The destination is accessed randomly, so there is no alignment to preserve.
+        if ((!spindleIsInParallelRegion()) || (0 == spindleGetLocalThreadID()))
+        {
+            for (size_t i = (num & ~((size_t)7)); i < num; ++i)
+                destination[indices[i]] = source[i];
+        }
+        
+        // Set up control information for the scatter operation.
+        memoryOpSpec.destination = (void*)destination;
+        memoryOpSpec.source = (const void*)source;
+        memoryOpSpec.indices = (const void*)indices;
+        memoryOpSpec.value = 0ull;
+        memoryOpSpec.num64 = num >> 3;
+        
+        if (spindleIsInParallelRegion())
+        {
+            spindleBarrierLocal();
+            parutilMemoryScatter64InternalThread((void*)&memoryOpSpec);
+        }
+        else
+        {
+            SSpindleTaskSpec taskSpec;
+            int32_t targetNUMANode = siloGetNUMANodeForVirtualAddress(destination);
+            
+            // Set up control information for Spindle.
+            if (0 > targetNUMANode)
+                targetNUMANode = 0;
+            
+            taskSpec.func = &parutilMemoryScatter64InternalThread;
+            taskSpec.arg = (void*)&memoryOpSpec;
+            taskSpec.numaNode = targetNUMANode;
+            taskSpec.numThreads = 0;
+            taskSpec.smtPolicy = SpindleSMTPolicyPreferPhysical;
+            
+            // Dispatch the scatter operation.
+            if (0 != parutilStatsThreadsSpawn(&taskSpec, ParutilStatsOperationMemoryScatter64))
+                return NULL;
+        }
+        
+        parutilStatsRecordOperation(ParutilStatsOperationMemoryScatter64, statsNumBytes, statsStartTimestamp, false, false);
+        return destination;
+    }
+}
+
+// --------
+
 void* parutilMemorySet(void* buffer, uint8_t value, size_t num)
 {
+    const uint64_t statsStartTimestamp = parutilStatsTimestamp();
+    const size_t statsNumBytes = num;
+    
     if (num < (kParutilMinimumOperationSize))
     {
         // For small enough buffers, it is not worth the overhead of setting up threads to parallelize.
@@ -260,6 +932,7 @@ void* parutilMemorySet(void* buffer, uint8_t value, size_t num)
                 ((uint8_t*)buffer)[i] = value;
         }
         
+        parutilStatsRecordOperation(ParutilStatsOperationMemorySet, statsNumBytes, statsStartTimestamp, true, false);
         return buffer;
     }
     else
@@ -297,6 +970,7 @@ void* parutilMemorySet(void* buffer, uint8_t value, size_t num)
         // Set up control information for the memory set operation.
         memoryOpSpec.destination = buffer;
         memoryOpSpec.source = NULL;
+        memoryOpSpec.indices = NULL;
         memoryOpSpec.value = (uint64_t)value;
         memoryOpSpec.value |= memoryOpSpec.value << 32ull;
         memoryOpSpec.value |= memoryOpSpec.value << 16ull;
@@ -324,10 +998,11 @@ void* parutilMemorySet(void* buffer, uint8_t value, size_t num)
             taskSpec.smtPolicy = SpindleSMTPolicyPreferPhysical;
             
             // Dispatch the memory set operation.
-            if (0 != spindleThreadsSpawn(&taskSpec, 1, false))
+            if (0 != parutilStatsThreadsSpawn(&taskSpec, ParutilStatsOperationMemorySet))
                 return NULL;
         }
 
+        parutilStatsRecordOperation(ParutilStatsOperationMemorySet, statsNumBytes, statsStartTimestamp, false, false);
         return buffer;
     }
 }
@@ -0,0 +1,400 @@
+/*****************************************************************************
+ * Parutil
+ *   Multi-platform library of parallelized utility functions.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Department of Electrical Engineering, Stanford University
+ * Copyright (c) 2016-2017
+ *************************************************************************//**
+ * @file partition.c
+ *   Implementation of radix partitioning operations.
+ *****************************************************************************/
+
+#include "../parutil.h"
+#include "scheduler.h"
+#include "stats.h"
+
+#include <immintrin.h>
+#include <silo.h>
+#include <spindle.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+// -------- CONSTANTS ------------------------------------------------------ //
+
+/// Minimum size of a partition operation, in bytes, before Parutil will parallelize it.
+static const size_t kParutilPartitionMinimumOperationSize = 64ull * 1024ull;
+
+/// Maximum number of key bits that can be used to identify a partition.
+/// Each thread holds one 64-byte write-combining buffer per partition, so this limits the buffers to 256kB per thread, which is intended to be cache-resident.
+static const uint8_t kParutilPartitionMaximumRadixBits = 12;
+
+
+// -------- TYPE DEFINITIONS ----------------------------------------------- //
+
+/// Contains all information needed to define a partition operation.
+/// For internal use only.
+typedef struct SParutilPartitionOperationSpec
+{
+    void* destination;                                                      ///< Base address of the destination memory buffer.
+    const void* source;                                                     ///< Base address of the source memory buffer.
+    size_t recordSize;                                                      ///< Size of each record, in bytes.
+    size_t numRecords;                                                      ///< Number of records to partition.
+    size_t keyOffset;                                                       ///< Byte offset of the 64-bit key within each record.
+    uint8_t radixShift;                                                     ///< Position of the least-significant key bit used to identify the partition.
+    uint8_t radixBits;                                                      ///< Number of key bits used to identify the partition.
+    size_t* partitionOffsets;                                               ///< Optional output array of partition starting indices.
+    bool success;                                                           ///< Result of the partition operation, written by the first thread when the operation is dispatched to a new Spindle task.
+} SParutilPartitionOperationSpec;
+
+/// Holds the state of a single thread's write-combining buffer for a single partition.
+/// Each buffer mirrors one 64-byte cache line of the destination memory buffer.
+/// For internal use only.
+typedef struct SParutilPartitionBufferState
+{
+    uint8_t* lineDestination;                                               ///< Address of the destination cache line currently mirrored by the buffer.
+    uint32_t fillSlot;                                                      ///< Next record slot to fill within the buffer.
+    uint32_t startSlot;                                                     ///< First valid record slot within the buffer. Non-zero only if the cache line is shared with records that belong to another thread or partition.
+} SParutilPartitionBufferState;
+
+
+// -------- INTERNAL FUNCTIONS --------------------------------------------- //
+
+/// Extracts the partition index from the specified record.
+/// @param [in] memoryOpSpec Information about the overall partition operation.
+/// @param [in] record Address of the record.
+/// @return Index of the partition to which the record belongs.
+static inline size_t parutilPartitionGetRadix(const SParutilPartitionOperationSpec* memoryOpSpec, const uint8_t* record)
+{
+    return (size_t)((*(const uint64_t*)(record + memoryOpSpec->keyOffset) >> memoryOpSpec->radixShift) & ((1ull << memoryOpSpec->radixBits) - 1ull));
+}
+
+/// Copies a single record using 64-bit operations.
+/// @param [in] destination Target address.
+/// @param [in] source Source address.
+/// @param [in] num8 Number of 8-byte words in the record.
+static inline void parutilPartitionCopyRecord(uint8_t* destination, const uint8_t* source, const size_t num8)
+{
+    for (size_t i = 0; i < num8; ++i)
+        ((uint64_t*)destination)[i] = ((const uint64_t*)source)[i];
+}
+
+/// Single-threaded implementation of partition operations, used when the operation is too small to benefit from parallelization.
+/// @param [in] memoryOpSpec Information about the overall partition operation.
+/// @return `true` if successful, `false` if memory could not be allocated.
+static bool parutilPartitionRadixSerial(SParutilPartitionOperationSpec* memoryOpSpec)
+{
+    const size_t fanout = (size_t)1 << memoryOpSpec->radixBits;
+    const size_t num8 = memoryOpSpec->recordSize >> 3;
+    const uint8_t* const source = (const uint8_t*)memoryOpSpec->source;
+    uint8_t* const destination = (uint8_t*)memoryOpSpec->destination;
+    size_t* writeOffsets = (size_t*)siloSimpleBufferAllocLocal(sizeof(size_t) * fanout);
+    size_t numRecordsSoFar = 0;
+
+    if (NULL == writeOffsets)
+        return false;
+
+    // Build a histogram of the records and turn it into the starting index of each partition.
+    for (size_t p = 0; p < fanout; ++p)
+        writeOffsets[p] = 0;
+
+    for (size_t i = 0; i < memoryOpSpec->numRecords; ++i)
+        writeOffsets[parutilPartitionGetRadix(memoryOpSpec, &source[i * memoryOpSpec->recordSize])] += 1;
+
+    for (size_t p = 0; p < fanout; ++p)
+    {
+        const size_t numRecordsInPartition = writeOffsets[p];
+
+        if (NULL != memoryOpSpec->partitionOffsets)
+            memoryOpSpec->partitionOffsets[p] = numRecordsSoFar;
+
+        writeOffsets[p] = numRecordsSoFar;
+        numRecordsSoFar += numRecordsInPartition;
+    }
+
+    if (NULL != memoryOpSpec->partitionOffsets)
+        memoryOpSpec->partitionOffsets[fanout] = numRecordsSoFar;
+
+    // Scatter each record directly to its final location.
+    for (size_t i = 0; i < memoryOpSpec->numRecords; ++i)
+    {
+        const uint8_t* const record = &source[i * memoryOpSpec->recordSize];
+        const size_t p = parutilPartitionGetRadix(memoryOpSpec, record);
+
+        parutilPartitionCopyRecord(&destination[writeOffsets[p] * memoryOpSpec->recordSize], record, num8);
+        writeOffsets[p] += 1;
+    }
+
+    siloFree(writeOffsets);
+    return true;
+}
+
+/// Parallelized implementation of partition operations.
+/// Intended to be called from within the context of a Spindle parallelized region, by all threads in the task.
+/// Each thread builds a histogram of a statically-scheduled chunk of the input, then scatters its records through per-partition cache-line buffers flushed using non-temporal stores.
+/// @param [in] memoryOpSpec Information about the overall partition operation.
+/// @return `true` if successful, `false` if memory could not be allocated.
+static bool parutilPartitionRadixParallel(SParutilPartitionOperationSpec* memoryOpSpec)
+{
+    const size_t fanout = (size_t)1 << memoryOpSpec->radixBits;
+    const size_t recordsPerLine = 64 / memoryOpSpec->recordSize;
+    const size_t num8 = memoryOpSpec->recordSize >> 3;
+    const uint8_t* const source = (const uint8_t*)memoryOpSpec->source;
+    uint8_t* const destination = (uint8_t*)memoryOpSpec->destination;
+    const uint32_t threadID = spindleGetLocalThreadID();
+    const uint32_t threadCount = spindleGetLocalThreadCount();
+
+    // Each thread's histogram is padded to a whole number of cache lines, and buffer state is likewise rounded up.
+    const size_t histogramStride = (fanout + 7) & ~((size_t)7);
+    const size_t bufferStateSize = (sizeof(SParutilPartitionBufferState) * fanout + 63) & ~((size_t)63);
+    const size_t threadRegionSize = (64 * fanout) + bufferStateSize + (sizeof(size_t) * histogramStride);
+
+    // Writing through the buffers requires that record boundaries line up with cache line boundaries in the destination.
+    const bool useWriteCombining = (0 == ((size_t)destination & (memoryOpSpec->recordSize - 1)));
+
+    SParutilStaticSchedule schedule;
+    void* workspace = NULL;
+
+    if (0 == threadID)
+    {
+        // First thread allocates and shares the workspace for all threads, which consists of buffers, buffer states, and histograms.
+        workspace = siloSimpleBufferAllocLocal((threadRegionSize * threadCount) + 64);
+        spindleDataShareSendLocal((uint64_t)workspace);
+    }
+    else
+    {
+        // All other threads wait for the address of the workspace.
+        workspace = (void*)spindleDataShareReceiveLocal();
+    }
+
+    if (NULL == workspace)
+        return false;
+
+    uint8_t* const threadRegionBase = (uint8_t*)(((size_t)workspace + 63) & ~((size_t)63));
+    uint8_t* const lineBuffers = &threadRegionBase[threadRegionSize * threadID];
+    SParutilPartitionBufferState* const bufferStates = (SParutilPartitionBufferState*)&lineBuffers[64 * fanout];
+    size_t* const histogram = (size_t*)&lineBuffers[(64 * fanout) + bufferStateSize];
+
+    // Build a histogram of the chunk of records assigned to this thread.
+    parutilSchedulerStaticChunkedInternal((uint64_t)memoryOpSpec->numRecords, &schedule);
+
+    for (size_t p = 0; p < fanout; ++p)
+        histogram[p] = 0;
+
+    for (uint64_t i = schedule.startUnit; i < schedule.endUnit; i += schedule.increment)
+        histogram[parutilPartitionGetRadix(memoryOpSpec, &source[i * memoryOpSpec->recordSize])] += 1;
+
+    spindleBarrierLocal();
+
+    // Compute the location at which this thread writes each partition.
+    // Partitions are ordered first by partition index and then by thread, which preserves the relative order of records within each partition.
+    {
+        size_t numRecordsSoFar = 0;
+
+        for (size_t p = 0; p < fanout; ++p)
+        {
+            size_t writeOffset = numRecordsSoFar;
+
+            for (uint32_t t = 0; t < threadCount; ++t)
+            {
+                const size_t* const threadHistogram = (const size_t*)&threadRegionBase[(threadRegionSize * t) + (64 * fanout) + bufferStateSize];
+                const size_t numRecordsFromThread = threadHistogram[p];
+
+                if (t < threadID)
+                    writeOffset += numRecordsFromThread;
+
+                numRecordsSoFar += numRecordsFromThread;
+            }
+
+            if ((0 == threadID) && (NULL != memoryOpSpec->partitionOffsets))
+                memoryOpSpec->partitionOffsets[p] = writeOffset;
+
+            if (useWriteCombining)
+            {
+                const size_t writeAddress = (size_t)&destination[writeOffset * memoryOpSpec->recordSize];
+
+                bufferStates[p].lineDestination = (uint8_t*)(writeAddress & ~((size_t)63));
+                bufferStates[p].fillSlot = (uint32_t)((writeAddress & 63) / memoryOpSpec->recordSize);
+                bufferStates[p].startSlot = bufferStates[p].fillSlot;
+            }
+            else
+            {
+                bufferStates[p].lineDestination = &destination[writeOffset * memoryOpSpec->recordSize];
+            }
+        }
+
+        if ((0 == threadID) && (NULL != memoryOpSpec->partitionOffsets))
+            memoryOpSpec->partitionOffsets[fanout] = numRecordsSoFar;
+    }
+
+    // Scatter the records assigned to this thread.
+    if (useWriteCombining)
+    {
+        for (uint64_t i = schedule.startUnit; i < schedule.endUnit; i += schedule.increment)
+        {
+            const uint8_t* const record = &source[i * memoryOpSpec->recordSize];
+            const size_t p = parutilPartitionGetRadix(memoryOpSpec, record);
+            SParutilPartitionBufferState* const bufferState = &bufferStates[p];
+            uint8_t* const lineBuffer = &lineBuffers[64 * p];
+
+            parutilPartitionCopyRecord(&lineBuffer[bufferState->fillSlot * memoryOpSpec->recordSize], record, num8);
+            bufferState->fillSlot += 1;
+
+            if (recordsPerLine == bufferState->fillSlot)
+            {
+                if (0 == bufferState->startSlot)
+                {
+                    // The entire destination cache line belongs to this thread and partition, so it can be written using non-temporal hints.
+                    _mm256_stream_si256((__m256i*)&bufferState->lineDestination[0], _mm256_load_si256((const __m256i*)&lineBuffer[0]));
+                    _mm256_stream_si256((__m256i*)&bufferState->lineDestination[32], _mm256_load_si256((const __m256i*)&lineBuffer[32]));
+                }
+                else
+                {
+                    // The destination cache line is shared with records written by another thread or belonging to another partition, so only the valid records are written.
+                    for (size_t slot = bufferState->startSlot; slot < recordsPerLine; ++slot)
+                        parutilPartitionCopyRecord(&bufferState->lineDestination[slot * memoryOpSpec->recordSize], &lineBuffer[slot * memoryOpSpec->recordSize], num8);
+
+                    bufferState->startSlot = 0;
+                }
+
+                bufferState->lineDestination += 64;
+                bufferState->fillSlot = 0;
+            }
+        }
+
+        // Write out any partially-filled buffers.
+        for (size_t p = 0; p < fanout; ++p)
+        {
+            for (size_t slot = bufferStates[p].startSlot; slot < bufferStates[p].fillSlot; ++slot)
+                parutilPartitionCopyRecord(&bufferStates[p].lineDestination[slot * memoryOpSpec->recordSize], &lineBuffers[(64 * p) + (slot * memoryOpSpec->recordSize)], num8);
+        }
+
+        _mm_sfence();
+    }
+    else
+    {
+        for (uint64_t i = schedule.startUnit; i < schedule.endUnit; i += schedule.increment)
+        {
+            const uint8_t* const record = &source[i * memoryOpSpec->recordSize];
+            const size_t p = parutilPartitionGetRadix(memoryOpSpec, record);
+
+            parutilPartitionCopyRecord(bufferStates[p].lineDestination, record, num8);
+            bufferStates[p].lineDestination += memoryOpSpec->recordSize;
+        }
+    }
+
+    // First thread frees the workspace once all threads are finished with it.
+    spindleBarrierLocal();
+
+    if (0 == threadID)
+        siloFree(workspace);
+
+    return true;
+}
+
+/// Internal control function for partition operations.
+/// @param [in] arg Pointer to the #SParutilPartitionOperationSpec structure that contains information about the overall partition operation to be parallelized.
+static void parutilPartitionRadixInternalThread(void* arg)
+{
+    SParutilPartitionOperationSpec* memoryOpSpec = (SParutilPartitionOperationSpec*)arg;
+    const bool result = parutilPartitionRadixParallel(memoryOpSpec);
+
+    if (0 == spindleGetLocalThreadID())
+        memoryOpSpec->success = result;
+}
+
+
+// -------- FUNCTIONS ------------------------------------------------------ //
+// See "parutil.h" for documentation.
+
+bool parutilPartitionRadix(void* destination, const void* source, const size_t recordSize, const size_t numRecords, const size_t keyOffset, const uint8_t radixShift, const uint8_t radixBits, size_t* const partitionOffsets)
+{
+    const uint64_t statsStartTimestamp = parutilStatsTimestamp();
+    SParutilPartitionOperationSpec memoryOpSpec;
+
+    // Check pre-conditions for this function.
+    if ((NULL == destination) || (NULL == source))
+        return false;
+
+    switch (recordSize)
+    {
+    case 8:
+    case 16:
+    case 32:
+    case 64:
+        break;
+
+    default:
+        return false;
+    }
+
+    if ((0 != (keyOffset & 7)) || (keyOffset + sizeof(uint64_t) > recordSize))
+        return false;
+
+    if ((0 == radixBits) || (radixBits > kParutilPartitionMaximumRadixBits) || (((uint32_t)radixShift + (uint32_t)radixBits) > 64))
+        return false;
+
+    // Set up control information for the partition operation.
+    memoryOpSpec.destination = destination;
+    memoryOpSpec.source = source;
+    memoryOpSpec.recordSize = recordSize;
+    memoryOpSpec.numRecords = numRecords;
+    memoryOpSpec.keyOffset = keyOffset;
+    memoryOpSpec.radixShift = radixShift;
+    memoryOpSpec.radixBits = radixBits;
+    memoryOpSpec.partitionOffsets = partitionOffsets;
+    memoryOpSpec.success = false;
+
+    if ((numRecords * recordSize) < kParutilPartitionMinimumOperationSize)
+    {
+        // For small enough inputs, it is not worth the overhead of setting up threads to parallelize.
+        if (spindleIsInParallelRegion())
+        {
+            // First thread performs the operation and shares the result, which also synchronizes all threads with its completion.
+            if (0 == spindleGetLocalThreadID())
+            {
+                memoryOpSpec.success = parutilPartitionRadixSerial(&memoryOpSpec);
+                spindleDataShareSendLocal((uint64_t)memoryOpSpec.success);
+            }
+            else
+            {
+                memoryOpSpec.success = (0 != spindleDataShareReceiveLocal());
+            }
+        }
+        else
+        {
+            memoryOpSpec.success = parutilPartitionRadixSerial(&memoryOpSpec);
+        }
+    }
+    else if (spindleIsInParallelRegion())
+    {
+        spindleBarrierLocal();
+        memoryOpSpec.success = parutilPartitionRadixParallel(&memoryOpSpec);
+    }
+    else
+    {
+        SSpindleTaskSpec taskSpec;
+        int32_t targetNUMANode = siloGetNUMANodeForVirtualAddress(destination);
+
+        // Set up control information for Spindle.
+        if (0 > targetNUMANode)
+            targetNUMANode = 0;
+
+        taskSpec.func = &parutilPartitionRadixInternalThread;
+        taskSpec.arg = (void*)&memoryOpSpec;
+        taskSpec.numaNode = targetNUMANode;
+        taskSpec.numThreads = 0;
+        taskSpec.smtPolicy = SpindleSMTPolicyPreferPhysical;
+
+        // Dispatch the partition operation.
+        if (0 != parutilStatsThreadsSpawn(&taskSpec, ParutilStatsOperationPartitionRadix))
+            return false;
+    }
+
+    if (memoryOpSpec.success)
+        parutilStatsRecordOperation(ParutilStatsOperationPartitionRadix, numRecords * recordSize, statsStartTimestamp, ((numRecords * recordSize) < kParutilPartitionMinimumOperationSize), (((numRecords * recordSize) >= kParutilPartitionMinimumOperationSize) && (0 != (((size_t)destination) & (recordSize - 1)))));
+
+    return memoryOpSpec.success;
+}
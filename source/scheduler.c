@@ -11,6 +11,8 @@
  *****************************************************************************/
 
 #include "../parutil.h"
+#include "scheduler.h"
+#include "stats.h"
 
 #include <silo.h>
 #include <spindle.h>
@@ -28,16 +30,6 @@ typedef struct SParutilDynamicSchedule
 } SParutilDynamicSchedule;
 
 
-// -------- INTERNAL FUNCTIONS --------------------------------------------- //
-
-/// Internal initializaton function for a static chunked scheduler.
-/// @param [in] units Total number of units of work that need to be scheduled.
-/// @param [out] schedule Scheduling information, provided as output.
-void parutilSchedulerStaticChunkedInternal(const uint64_t units, SParutilStaticSchedule* const schedule);
-
-
-
-
 // -------- FUNCTIONS ------------------------------------------------------ //
 // See "parutil.h" for documentation.
 
@@ -47,6 +39,8 @@ bool parutilSchedulerStatic(const EParutilStaticScheduler type, const uint64_t u
     if ((!spindleIsInParallelRegion()) || (NULL == schedule))
         return false;
     
+    parutilStatsRecordSchedulerStatic();
+    
     // Branch based on the scheduler type that was selected.
     switch (type)
     {
@@ -69,6 +63,8 @@ uint64_t parutilSchedulerDynamicInit(const uint64_t numUnits, void** schedule)
     {
         SParutilDynamicSchedule* scheduleBuf = NULL;
 
+        parutilStatsRecordSchedulerDynamicInit();
+
         if (0 == spindleGetLocalThreadID())
         {
             // First thread allocates, initializes, and shares the dynamic scheduler object.
@@ -142,6 +138,8 @@ uint64_t parutilSchedulerDynamicGetWork(void* schedule)
     if ((!spindleIsInParallelRegion()) || (NULL == schedule))
         return UINT64_MAX;
 
+    parutilStatsRecordSchedulerDynamicGetWork();
+
     // Get the next unit of work for this thread.
     SParutilDynamicSchedule* const scheduleBuf = (SParutilDynamicSchedule*)schedule;
 
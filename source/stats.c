@@ -0,0 +1,286 @@
+/*****************************************************************************
+ * Parutil
+ *   Multi-platform library of parallelized utility functions.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Department of Electrical Engineering, Stanford University
+ * Copyright (c) 2016-2017
+ *************************************************************************//**
+ * @file stats.c
+ *   Implementation of statistics collection and reporting.
+ *****************************************************************************/
+
+#include "../parutil.h"
+#include "stats.h"
+
+#include <spindle.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef PARUTIL_STATS
+#ifdef PARUTIL_WINDOWS
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+#endif
+
+
+#ifdef PARUTIL_STATS
+
+// -------- CONSTANTS ------------------------------------------------------ //
+
+/// Number of time-stamp counter frequency measurement periods per second, which determines how long a single measurement takes.
+static const uint64_t kParutilStatsFrequencyMeasurementPeriodsPerSecond = 100;
+
+
+// -------- TYPE DEFINITIONS ----------------------------------------------- //
+
+/// Wraps the specification of a task dispatched by #parutilStatsThreadsSpawn.
+/// For internal use only.
+typedef struct SParutilStatsSpawnSpec
+{
+    void (*func)(void*);                                                    ///< Original task function.
+    void* arg;                                                              ///< Original task function argument.
+    EParutilStatsOperation operation;                                       ///< Operation being dispatched.
+    uint64_t spawnTimestamp;                                                ///< Time-stamp counter value immediately before spawning the task.
+} SParutilStatsSpawnSpec;
+
+
+// -------- GLOBALS -------------------------------------------------------- //
+
+SParutilStatsThreadSlot parutilStatsThreadSlots[PARUTIL_STATS_NUM_THREAD_SLOTS];
+
+PARUTIL_STATS_THREAD_LOCAL SParutilStatsThreadSlot* parutilStatsCurrentSlot = NULL;
+
+/// Measured time-stamp counter frequency, in Hz, or 0 if not yet measured.
+static uint64_t parutilStatsTimestampFrequency = 0;
+
+#ifdef PARUTIL_WINDOWS
+/// Guards creation of #parutilStatsSlotReleaseIndex.
+static INIT_ONCE parutilStatsSlotReleaseOnce = INIT_ONCE_STATIC_INIT;
+
+/// Fiber-local storage index whose callback releases the slot held by an exiting thread.
+static DWORD parutilStatsSlotReleaseIndex = FLS_OUT_OF_INDEXES;
+#else
+/// Guards creation of #parutilStatsSlotReleaseKey.
+static pthread_once_t parutilStatsSlotReleaseOnce = PTHREAD_ONCE_INIT;
+
+/// Thread-specific data key whose destructor releases the slot held by an exiting thread.
+static pthread_key_t parutilStatsSlotReleaseKey;
+
+/// Indicates whether or not #parutilStatsSlotReleaseKey was successfully created.
+static bool parutilStatsSlotReleaseKeyIsValid = false;
+#endif
+
+
+// -------- INTERNAL FUNCTIONS --------------------------------------------- //
+
+/// Releases a slot previously claimed by #parutilStatsClaimSlot, so that it can be claimed by another thread.
+/// Invoked automatically when the thread that holds the slot exits.
+/// @param [in] slot Slot to release.
+#ifdef PARUTIL_WINDOWS
+static void WINAPI parutilStatsReleaseSlot(void* slot)
+#else
+static void parutilStatsReleaseSlot(void* slot)
+#endif
+{
+    if (NULL != slot)
+        parutilAtomicExchange32(&((SParutilStatsThreadSlot*)slot)->isClaimed, 0);
+}
+
+#ifdef PARUTIL_WINDOWS
+/// Creates the fiber-local storage index used to release slots. Invoked once by `InitOnceExecuteOnce`.
+/// @return Always `TRUE`, since failure is detected by the index remaining invalid.
+static BOOL CALLBACK parutilStatsCreateSlotRelease(PINIT_ONCE initOnce, void* param, void** context)
+{
+    parutilStatsSlotReleaseIndex = FlsAlloc(&parutilStatsReleaseSlot);
+    return TRUE;
+}
+#else
+/// Creates the thread-specific data key used to release slots. Invoked once by `pthread_once`.
+static void parutilStatsCreateSlotRelease(void)
+{
+    parutilStatsSlotReleaseKeyIsValid = (0 == pthread_key_create(&parutilStatsSlotReleaseKey, &parutilStatsReleaseSlot));
+}
+#endif
+
+/// Arranges for a slot to be released when the current thread exits.
+/// @param [in] slot Slot to release.
+/// @return `true` if successful, `false` otherwise, in which case the slot must not be kept.
+static bool parutilStatsRegisterSlotRelease(SParutilStatsThreadSlot* slot)
+{
+#ifdef PARUTIL_WINDOWS
+    InitOnceExecuteOnce(&parutilStatsSlotReleaseOnce, &parutilStatsCreateSlotRelease, NULL, NULL);
+    return ((FLS_OUT_OF_INDEXES != parutilStatsSlotReleaseIndex) && FlsSetValue(parutilStatsSlotReleaseIndex, (void*)slot));
+#else
+    pthread_once(&parutilStatsSlotReleaseOnce, &parutilStatsCreateSlotRelease);
+    return (parutilStatsSlotReleaseKeyIsValid && (0 == pthread_setspecific(parutilStatsSlotReleaseKey, (void*)slot)));
+#endif
+}
+
+/// Measures the frequency of the time-stamp counter against the operating system's monotonic clock.
+/// Busy-waits for one measurement period.
+/// @return Time-stamp counter frequency, in Hz.
+static uint64_t parutilStatsMeasureTimestampFrequency(void)
+{
+#ifdef PARUTIL_WINDOWS
+    LARGE_INTEGER clockFrequency;
+    LARGE_INTEGER clockStart;
+    LARGE_INTEGER clockNow;
+
+    QueryPerformanceFrequency(&clockFrequency);
+    QueryPerformanceCounter(&clockStart);
+    const uint64_t timestampStart = parutilStatsTimestamp();
+
+    do
+    {
+        QueryPerformanceCounter(&clockNow);
+    } while ((uint64_t)(clockNow.QuadPart - clockStart.QuadPart) < ((uint64_t)clockFrequency.QuadPart / kParutilStatsFrequencyMeasurementPeriodsPerSecond));
+
+    const uint64_t timestampEnd = parutilStatsTimestamp();
+    return ((timestampEnd - timestampStart) * (uint64_t)clockFrequency.QuadPart) / (uint64_t)(clockNow.QuadPart - clockStart.QuadPart);
+#else
+    struct timespec clockStart;
+    struct timespec clockNow;
+    uint64_t elapsedNanoseconds;
+
+    clock_gettime(CLOCK_MONOTONIC, &clockStart);
+    const uint64_t timestampStart = parutilStatsTimestamp();
+
+    do
+    {
+        clock_gettime(CLOCK_MONOTONIC, &clockNow);
+        elapsedNanoseconds = ((uint64_t)(clockNow.tv_sec - clockStart.tv_sec) * 1000000000ull) + (uint64_t)clockNow.tv_nsec - (uint64_t)clockStart.tv_nsec;
+    } while (elapsedNanoseconds < (1000000000ull / kParutilStatsFrequencyMeasurementPeriodsPerSecond));
+
+    const uint64_t timestampEnd = parutilStatsTimestamp();
+    return ((timestampEnd - timestampStart) * 1000000000ull) / elapsedNanoseconds;
+#endif
+}
+
+/// Task function used by #parutilStatsThreadsSpawn.
+/// First thread records the time taken to start work, and then all threads invoke the original task function.
+/// @param [in] arg Pointer to the #SParutilStatsSpawnSpec structure that describes the original task.
+static void parutilStatsSpawnInternalThread(void* arg)
+{
+    SParutilStatsSpawnSpec* spawnSpec = (SParutilStatsSpawnSpec*)arg;
+
+    if (0 == spindleGetLocalThreadID())
+    {
+        SParutilStatsThreadSlot* const slot = parutilStatsGetSlot();
+        parutilStatsAdd(slot, &slot->operations[spawnSpec->operation].numSpawnCycles, parutilStatsTimestamp() - spawnSpec->spawnTimestamp);
+    }
+
+    spawnSpec->func(spawnSpec->arg);
+}
+
+#endif
+
+
+// -------- FUNCTIONS ------------------------------------------------------ //
+// See "parutil.h" and "stats.h" for documentation.
+
+#ifdef PARUTIL_STATS
+SParutilStatsThreadSlot* parutilStatsClaimSlot(void)
+{
+    SParutilStatsThreadSlot* slot = &parutilStatsThreadSlots[0];
+
+    // Slot 0 is shared, so it is never claimed.
+    for (uint32_t i = 1; i < PARUTIL_STATS_NUM_THREAD_SLOTS; ++i)
+    {
+        if ((0 == parutilStatsThreadSlots[i].isClaimed) && (0 == parutilAtomicExchange32(&parutilStatsThreadSlots[i].isClaimed, 1)))
+        {
+            if (parutilStatsRegisterSlotRelease(&parutilStatsThreadSlots[i]))
+                slot = &parutilStatsThreadSlots[i];
+            else
+                parutilStatsReleaseSlot(&parutilStatsThreadSlots[i]);
+
+            break;
+        }
+    }
+
+    parutilStatsCurrentSlot = slot;
+    return slot;
+}
+
+// --------
+#endif
+
+uint32_t parutilStatsThreadsSpawn(SSpindleTaskSpec* taskSpec, const EParutilStatsOperation operation)
+{
+#ifdef PARUTIL_STATS
+    SParutilStatsSpawnSpec spawnSpec;
+
+    // Interpose on the task function so that the first thread can record when it starts work.
+    spawnSpec.func = taskSpec->func;
+    spawnSpec.arg = taskSpec->arg;
+    spawnSpec.operation = operation;
+
+    taskSpec->func = &parutilStatsSpawnInternalThread;
+    taskSpec->arg = (void*)&spawnSpec;
+
+    spawnSpec.spawnTimestamp = parutilStatsTimestamp();
+#endif
+
+    return spindleThreadsSpawn(taskSpec, 1, false);
+}
+
+// --------
+
+bool parutilStatsSnapshot(SParutilStats* const stats)
+{
+#ifdef PARUTIL_STATS
+    // Check pre-conditions for this function.
+    if (NULL == stats)
+        return false;
+
+    // Per-operation statistics are summed over all slots, treating each structure as an array of counters.
+    for (size_t op = 0; op < ParutilStatsOperationCount; ++op)
+    {
+        uint64_t* const totals = (uint64_t*)&stats->operations[op];
+
+        for (size_t i = 0; i < (sizeof(SParutilStatsOperation) / sizeof(uint64_t)); ++i)
+            totals[i] = 0ull;
+
+        for (size_t slot = 0; slot < PARUTIL_STATS_NUM_THREAD_SLOTS; ++slot)
+        {
+            const uint64_t* const counters = (const uint64_t*)&parutilStatsThreadSlots[slot].operations[op];
+
+            for (size_t i = 0; i < (sizeof(SParutilStatsOperation) / sizeof(uint64_t)); ++i)
+                totals[i] += counters[i];
+        }
+    }
+
+    // Scheduling assistance statistics are reported per slot.
+    for (size_t slot = 0; slot < PARUTIL_STATS_NUM_THREAD_SLOTS; ++slot)
+        stats->scheduler[slot] = parutilStatsThreadSlots[slot].scheduler;
+
+    // Time-stamp counter frequency is measured once, the first time it is needed.
+    if (0 == parutilStatsTimestampFrequency)
+        parutilStatsTimestampFrequency = parutilStatsMeasureTimestampFrequency();
+
+    stats->tscFrequencyHz = parutilStatsTimestampFrequency;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+// --------
+
+void parutilStatsReset(void)
+{
+#ifdef PARUTIL_STATS
+    for (size_t slot = 0; slot < PARUTIL_STATS_NUM_THREAD_SLOTS; ++slot)
+    {
+        uint64_t* const counters = (uint64_t*)&parutilStatsThreadSlots[slot];
+
+        for (size_t i = 0; i < ((sizeof(SParutilStatsOperation) * ParutilStatsOperationCount + sizeof(SParutilStatsScheduler)) / sizeof(uint64_t)); ++i)
+            counters[i] = 0ull;
+    }
+#endif
+}